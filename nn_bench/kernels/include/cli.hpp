@@ -0,0 +1,15 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include "harness.hpp"
+
+struct CliArgs {
+    static CliArgs parse(int argc, char** argv);
+
+    BenchOptions options;
+    // Only run benchmarks whose name contains this
+    std::optional<std::string> filter;
+    std::optional<std::string> output_path;
+    unsigned seed;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Keeps the compiler from discarding a result that is otherwise unused
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct BenchOptions {
+    int repetitions;
+    std::chrono::milliseconds warmup;
+    // Every repetition runs enough iterations to take at least this long
+    std::chrono::milliseconds min_repetition_time;
+};
+
+// Nanoseconds per iteration across repetitions
+struct Stats {
+    double min;
+    double median;
+    double mean;
+    double stddev;
+    double max;
+};
+
+struct BenchResult {
+    std::string name;
+    int64_t iterations_per_repetition;
+    Stats stats;
+};
+
+BenchResult run_benchmark(
+    const std::string& name, const std::function<void()>& body, const BenchOptions& options
+);
+
+Stats compute_stats(std::vector<double> samples);
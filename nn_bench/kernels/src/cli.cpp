@@ -0,0 +1,57 @@
+#include "cli.hpp"
+#include <print>
+#include <string_view>
+
+void print_usage_and_exit() {
+    std::println("Usage: nn_kernel_bench [options]");
+    std::println("  --filter <substring>     Only run benchmarks whose name contains this");
+    std::println("  --repetitions <n>        Timed repetitions per benchmark (default: 10)");
+    std::println("  --warmup-ms <ms>         Warmup time per benchmark (default: 200)");
+    std::println("  --min-time-ms <ms>       Minimum time per repetition (default: 50)");
+    std::println("  --output <file>          Also write the results as JSON");
+    std::println("  --seed <n>               Seed for the random fixtures (default: 0)");
+    std::exit(1);
+}
+
+CliArgs CliArgs::parse(int argc, char** argv) {
+    CliArgs args;
+    args.options.repetitions = 10;
+    args.options.warmup = std::chrono::milliseconds(200);
+    args.options.min_repetition_time = std::chrono::milliseconds(50);
+    args.seed = 0;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i == argc - 1) {
+                    print_usage_and_exit();
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--filter") {
+                args.filter = value();
+            } else if (arg == "--repetitions") {
+                args.options.repetitions = std::stoi(value());
+            } else if (arg == "--warmup-ms") {
+                args.options.warmup = std::chrono::milliseconds(std::stoi(value()));
+            } else if (arg == "--min-time-ms") {
+                args.options.min_repetition_time = std::chrono::milliseconds(std::stoi(value()));
+            } else if (arg == "--output") {
+                args.output_path = value();
+            } else if (arg == "--seed") {
+                args.seed = std::stoul(value());
+            } else {
+                print_usage_and_exit();
+            }
+        }
+    } catch (const std::exception&) {
+        print_usage_and_exit();
+    }
+
+    if (args.options.repetitions < 1) {
+        print_usage_and_exit();
+    }
+    return args;
+}
@@ -0,0 +1,66 @@
+#include "harness.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+double time_iterations(const std::function<void()>& body, int64_t iterations) {
+    auto start = Clock::now();
+    for (int64_t i = 0; i < iterations; i++) {
+        body();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+}
+
+BenchResult run_benchmark(
+    const std::string& name, const std::function<void()>& body, const BenchOptions& options
+) {
+    // Warm caches and the allocator while estimating the cost of a single iteration
+    int64_t warmup_iterations = 0;
+    auto warmup_start = Clock::now();
+    do {
+        body();
+        warmup_iterations++;
+    } while (Clock::now() - warmup_start < options.warmup);
+    double warmup_ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - warmup_start).count();
+
+    double estimate_ns = warmup_ns / warmup_iterations;
+    double target_ns =
+        std::chrono::duration<double, std::nano>(options.min_repetition_time).count();
+    int64_t iterations = std::max<int64_t>(1, std::ceil(target_ns / estimate_ns));
+
+    std::vector<double> samples;
+    samples.reserve(options.repetitions);
+    for (int rep = 0; rep < options.repetitions; rep++) {
+        samples.push_back(time_iterations(body, iterations) / iterations);
+    }
+
+    return BenchResult{ name, iterations, compute_stats(std::move(samples)) };
+}
+
+Stats compute_stats(std::vector<double> samples) {
+    std::ranges::sort(samples);
+
+    Stats stats;
+    stats.min = samples.front();
+    stats.max = samples.back();
+
+    size_t mid = samples.size() / 2;
+    stats.median = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+    double sq_sum = 0;
+    for (double s : samples) {
+        sq_sum += (s - stats.mean) * (s - stats.mean);
+    }
+    stats.stddev = samples.size() > 1 ? std::sqrt(sq_sum / (samples.size() - 1)) : 0;
+
+    return stats;
+}
@@ -0,0 +1,178 @@
+#include <Eigen/Core>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <nn_lib/activation.hpp>
+#include <nn_lib/loss.hpp>
+#include <nn_lib/network.hpp>
+#include <print>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cli.hpp"
+#include "harness.hpp"
+
+using Eigen::MatrixXd;
+using nlohmann::json;
+
+const std::vector<int> LAYER_SIZES = { 784, 128, 10 };
+const std::vector<int> FEED_FORWARD_BATCH_SIZES = { 1, 32, 1024 };
+const int BATCH_SIZE = 32;
+
+const std::vector<std::string> HIDDEN_ACTIVATIONS = { "relu", "sigmoid", "linear" };
+const std::vector<std::string> OUTPUT_ACTIVATIONS = { "softmax", "sigmoid", "linear" };
+const std::vector<std::string> LOSSES = { "mse", "cross_entropy" };
+
+// Pixel-like inputs in [0, 1]
+MatrixXd random_inputs(int rows, int cols) {
+    return (MatrixXd::Random(rows, cols).array() + 1.0) / 2.0;
+}
+
+MatrixXd random_onehot(int rows, int cols) {
+    MatrixXd y = MatrixXd::Zero(rows, cols);
+    for (int c = 0; c < cols; c++) {
+        y(std::rand() % rows, c) = 1.0;
+    }
+    return y;
+}
+
+using Benchmark = std::pair<std::string, std::function<void()>>;
+
+std::vector<Benchmark> make_benchmarks() {
+    std::vector<Benchmark> benchmarks;
+
+    auto network_opt = nn::Network::new_random(
+        LAYER_SIZES, { nn::activation::ReLU{} }, nn::activation::SoftMax{}, nn::loss::CrossEntropy{}
+    );
+    auto network = std::make_shared<nn::Network>(network_opt.value());
+
+    for (int batch_size : FEED_FORWARD_BATCH_SIZES) {
+        auto x = std::make_shared<MatrixXd>(random_inputs(LAYER_SIZES.front(), batch_size));
+        benchmarks.emplace_back(std::format("feed_forward/b{}", batch_size), [network, x] {
+            do_not_optimize(network->feed_forward(*x));
+        });
+    }
+
+    {
+        auto x = std::make_shared<MatrixXd>(random_inputs(LAYER_SIZES.front(), BATCH_SIZE));
+        auto y = std::make_shared<MatrixXd>(random_onehot(LAYER_SIZES.back(), BATCH_SIZE));
+        benchmarks.emplace_back(std::format("compute_gradients/b{}", BATCH_SIZE), [network, x, y] {
+            do_not_optimize(network->compute_gradients(*x, *y));
+        });
+    }
+
+    for (const auto& activation_name : OUTPUT_ACTIVATIONS) {
+        for (const auto& loss_name : LOSSES) {
+            auto activation = nn::str_to_output_activation(activation_name).value();
+            auto loss = nn::str_to_loss(loss_name).value();
+
+            auto z = std::make_shared<MatrixXd>(MatrixXd::Random(LAYER_SIZES.back(), BATCH_SIZE));
+            auto a = std::make_shared<MatrixXd>(nn::apply_activation(activation, *z));
+            auto y = std::make_shared<MatrixXd>(random_onehot(LAYER_SIZES.back(), BATCH_SIZE));
+            benchmarks.emplace_back(
+                std::format("output_delta/{}+{}/b{}", activation_name, loss_name, BATCH_SIZE),
+                [activation, loss, z, a, y] {
+                do_not_optimize(nn::output_delta(activation, loss, *z, *a, *y));
+            }
+            );
+        }
+    }
+
+    for (const auto& activation_name : HIDDEN_ACTIVATIONS) {
+        auto activation = nn::str_to_hidden_activation(activation_name).value();
+        auto z = std::make_shared<MatrixXd>(MatrixXd::Random(LAYER_SIZES[1], BATCH_SIZE));
+        benchmarks.emplace_back(
+            std::format("apply_activation/hidden/{}/{}x{}", activation_name, z->rows(), z->cols()),
+            [activation, z] {
+            do_not_optimize(nn::apply_activation(activation, *z));
+        }
+        );
+    }
+    for (const auto& activation_name : OUTPUT_ACTIVATIONS) {
+        auto activation = nn::str_to_output_activation(activation_name).value();
+        auto z = std::make_shared<MatrixXd>(MatrixXd::Random(LAYER_SIZES.back(), BATCH_SIZE));
+        benchmarks.emplace_back(
+            std::format("apply_activation/output/{}/{}x{}", activation_name, z->rows(), z->cols()),
+            [activation, z] {
+            do_not_optimize(nn::apply_activation(activation, *z));
+        }
+        );
+    }
+
+    {
+        auto weights = std::make_shared<std::vector<double>>(network->dump_weights());
+        auto biases = std::make_shared<std::vector<double>>(network->dump_biases());
+        benchmarks.emplace_back("from_data", [weights, biases] {
+            do_not_optimize(nn::Network::from_data(
+                LAYER_SIZES, *weights, *biases, { nn::activation::ReLU{} },
+                nn::activation::SoftMax{}, nn::loss::CrossEntropy{}
+            ));
+        });
+        benchmarks.emplace_back("dump_weights", [network] {
+            do_not_optimize(network->dump_weights());
+        });
+        benchmarks.emplace_back("dump_biases", [network] {
+            do_not_optimize(network->dump_biases());
+        });
+    }
+
+    return benchmarks;
+}
+
+json to_json(const BenchResult& result) {
+    return json{
+        { "name", result.name },
+        { "iterations_per_repetition", result.iterations_per_repetition },
+        { "min_ns", result.stats.min },
+        { "median_ns", result.stats.median },
+        { "mean_ns", result.stats.mean },
+        { "stddev_ns", result.stats.stddev },
+        { "max_ns", result.stats.max },
+    };
+}
+
+int main(int argc, char** argv) {
+    CliArgs args = CliArgs::parse(argc, argv);
+    // Kernels are measured on a single thread, comparable across machines
+    Eigen::setNbThreads(1);
+
+    std::srand(args.seed);
+    auto benchmarks = make_benchmarks();
+
+    std::println(
+        "{:<44} {:>14} {:>14} {:>14} {:>8}", "benchmark", "median (ns)", "mean (ns)", "min (ns)",
+        "cv (%)"
+    );
+
+    json results = json::array();
+    for (const auto& [name, body] : benchmarks) {
+        if (args.filter && !name.contains(*args.filter)) {
+            continue;
+        }
+
+        auto result = run_benchmark(name, body, args.options);
+        std::println(
+            "{:<44} {:>14.1f} {:>14.1f} {:>14.1f} {:>8.2f}", result.name, result.stats.median,
+            result.stats.mean, result.stats.min, 100.0 * result.stats.stddev / result.stats.mean
+        );
+        results.push_back(to_json(result));
+    }
+
+    if (args.output_path) {
+        json report = {
+            { "repetitions", args.options.repetitions },
+            { "warmup_ms", args.options.warmup.count() },
+            { "min_repetition_time_ms", args.options.min_repetition_time.count() },
+            { "seed", args.seed },
+            { "results", results },
+        };
+        std::ofstream out(*args.output_path);
+        out << report.dump(2) << "\n";
+        if (!out) {
+            std::println("Failed to write {}", *args.output_path);
+            return 1;
+        }
+    }
+}
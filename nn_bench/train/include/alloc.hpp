@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+// Number of heap allocations since the start of the process. Eigen allocates through malloc
+// rather than operator new, so this interposes malloc itself, which is only done on glibc
+std::optional<uint64_t> allocation_count();
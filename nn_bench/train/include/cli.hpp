@@ -0,0 +1,34 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+struct CliArgs {
+    static CliArgs parse(int argc, char** argv);
+
+    std::string train_inputs() const {
+        return data_dir + "/train_inputs.bin";
+    }
+    std::string train_labels() const {
+        return data_dir + "/train_labels.bin";
+    }
+    std::string test_inputs() const {
+        return data_dir + "/test_inputs.bin";
+    }
+    std::string test_labels() const {
+        return data_dir + "/test_labels.bin";
+    }
+
+    std::string data_dir;
+    std::string output_path;
+    // Only run configurations whose name contains this
+    std::optional<std::string> filter;
+
+    std::vector<int> batch_sizes;
+    std::vector<int> thread_counts;
+    int max_epochs;
+    double target_accuracy;
+    double learning_rate;
+    unsigned seed;
+};
@@ -0,0 +1,76 @@
+#include "alloc.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{ 0 };
+
+void count_allocation() {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+}
+
+#ifdef __GLIBC__
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* p);
+
+void* malloc(size_t size) {
+    count_allocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    count_allocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, size_t size) {
+    count_allocation();
+    return __libc_realloc(p, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    count_allocation();
+    void* p = __libc_memalign(alignment, size);
+    if (!p) {
+        return ENOMEM;
+    }
+    *out = p;
+    return 0;
+}
+
+void free(void* p) {
+    __libc_free(p);
+}
+}
+
+std::optional<uint64_t> allocation_count() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+std::optional<uint64_t> allocation_count() {
+    return std::nullopt;
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "cli.hpp"
+#include <algorithm>
+#include <print>
+#include <ranges>
+#include <string_view>
+
+void print_usage_and_exit() {
+    std::println("Usage: nn_train_bench [options]");
+    std::println("  --data <data_dir>        Preprocessed dataset directory (default: mnist_data)");
+    std::println("  --output <file>          JSON report path (default: train_bench.json)");
+    std::println("  --filter <substring>     Only run configurations whose name contains this");
+    std::println("  --batch-sizes <list>     Comma separated batch sizes (default: 32,128)");
+    std::println("  --threads <list>         Comma separated Eigen thread counts (default: 1)");
+    std::println("  --max-epochs <n>         Epochs per configuration (default: 5)");
+    std::println("  --target <accuracy>      Test accuracy for time-to-target (default: 0.97)");
+    std::println("  --learning-rate <lr>     Learning rate (default: 0.1)");
+    std::println("  --seed <n>               Seed for the initial weights (default: 0)");
+    std::exit(1);
+}
+
+std::vector<int> parse_int_list(std::string_view s) {
+    std::vector<int> values;
+    for (auto part : s | std::views::split(',')) {
+        values.push_back(std::stoi(std::string(part.begin(), part.end())));
+    }
+    return values;
+}
+
+CliArgs CliArgs::parse(int argc, char** argv) {
+    CliArgs args;
+    args.data_dir = "mnist_data";
+    args.output_path = "train_bench.json";
+    args.batch_sizes = { 32, 128 };
+    args.thread_counts = { 1 };
+    args.max_epochs = 5;
+    args.target_accuracy = 0.97;
+    args.learning_rate = 0.1;
+    args.seed = 0;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i == argc - 1) {
+                    print_usage_and_exit();
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--data") {
+                args.data_dir = value();
+            } else if (arg == "--output") {
+                args.output_path = value();
+            } else if (arg == "--filter") {
+                args.filter = value();
+            } else if (arg == "--batch-sizes") {
+                args.batch_sizes = parse_int_list(value());
+            } else if (arg == "--threads") {
+                args.thread_counts = parse_int_list(value());
+            } else if (arg == "--max-epochs") {
+                args.max_epochs = std::stoi(value());
+            } else if (arg == "--target") {
+                args.target_accuracy = std::stod(value());
+            } else if (arg == "--learning-rate") {
+                args.learning_rate = std::stod(value());
+            } else if (arg == "--seed") {
+                args.seed = std::stoul(value());
+            } else {
+                print_usage_and_exit();
+            }
+        }
+    } catch (const std::exception&) {
+        print_usage_and_exit();
+    }
+
+    auto positive = [](int v) { return v >= 1; };
+    if (args.max_epochs < 1 || args.batch_sizes.empty() || args.thread_counts.empty()
+        || !std::ranges::all_of(args.batch_sizes, positive)
+        || !std::ranges::all_of(args.thread_counts, positive)) {
+        print_usage_and_exit();
+    }
+    return args;
+}
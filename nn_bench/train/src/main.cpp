@@ -0,0 +1,222 @@
+#include <Eigen/Core>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <nn_lib/network.hpp>
+#include <ranges>
+#include <string>
+#include <vector>
+#include "alloc.hpp"
+#include "cli.hpp"
+#include "dataset.hpp"
+#include "memmat.hpp"
+#include "spdlog/spdlog.h"
+
+using nlohmann::json;
+
+struct Topology {
+    std::string name;
+    std::vector<int> layer_sizes;
+};
+
+// Output activation and the loss it is trained with
+struct Head {
+    std::string output_activation;
+    std::string loss;
+};
+
+const std::vector<Topology> TOPOLOGIES = {
+    { "784-128-10", { 784, 128, 10 } },
+    { "784-256-128-10", { 784, 256, 128, 10 } },
+};
+const std::vector<std::string> HIDDEN_ACTIVATIONS = { "relu", "sigmoid" };
+const std::vector<Head> HEADS = {
+    { "softmax", "cross_entropy" },
+    { "sigmoid", "mse" },
+};
+
+struct BenchConfig {
+    Topology topology;
+    std::string hidden_activation;
+    Head head;
+    int batch_size;
+    int threads;
+
+    std::string name() const {
+        return std::format(
+            "{}/{}/{}+{}/b{}/t{}", topology.name, hidden_activation, head.output_activation,
+            head.loss, batch_size, threads
+        );
+    }
+
+    std::vector<std::string> activations() const {
+        std::vector<std::string> activations(topology.layer_sizes.size() - 2, hidden_activation);
+        activations.push_back(head.output_activation);
+        return activations;
+    }
+};
+
+struct Dataset {
+    Eigen::Map<const Eigen::MatrixXd> train_inputs;
+    Eigen::Map<const Eigen::MatrixXd> train_labels;
+    // Materialized once so evaluation does not copy the mapping on every epoch
+    Eigen::MatrixXd test_inputs;
+    std::vector<int> test_labels;
+};
+
+// Resets the peak RSS reported by /proc/self/status (Linux 4.0+)
+void reset_peak_rss() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// In KiB
+long peak_rss() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.starts_with("VmHWM:")) {
+            return std::stol(line.substr(6));
+        }
+    }
+    return -1;
+}
+
+json run_config(const BenchConfig& config, const Dataset& data, const CliArgs& args) {
+    Eigen::setNbThreads(config.threads);
+
+    auto activations = config.activations();
+    auto hidden_activations_view = activations | std::views::take(activations.size() - 1);
+    auto hidden_activations = nn::strs_to_hidden_activation(hidden_activations_view).value();
+    auto output_activation = nn::str_to_output_activation(activations.back()).value();
+    auto loss = nn::str_to_loss(config.head.loss).value();
+
+    std::srand(args.seed);
+    auto network_opt = nn::Network::new_random(
+        config.topology.layer_sizes, hidden_activations, output_activation, loss
+    );
+    auto network = network_opt.value();
+
+    nn::SGDHyperparams hyperparams{ args.learning_rate, 1, config.batch_size, std::nullopt,
+                                    std::nullopt };
+    int batches_per_epoch = (TRAIN_SIZE + config.batch_size - 1) / config.batch_size;
+
+    reset_peak_rss();
+
+    double train_seconds = 0;
+    std::optional<uint64_t> train_allocations = allocation_count() ? std::optional<uint64_t>(0)
+                                                                   : std::nullopt;
+    std::optional<double> time_to_target;
+    json epochs = json::array();
+
+    for (int epoch = 1; epoch <= args.max_epochs; epoch++) {
+        auto allocations_before = allocation_count();
+        auto start = std::chrono::steady_clock::now();
+
+        network.train_sgd(data.train_inputs, data.train_labels, hyperparams);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (train_allocations) {
+            *train_allocations += *allocation_count() - *allocations_before;
+        }
+        train_seconds += elapsed.count();
+
+        int correct = network.evaluate_onehot(data.test_inputs, data.test_labels);
+        double accuracy = static_cast<double>(correct) / TEST_SIZE;
+        if (!time_to_target && accuracy >= args.target_accuracy) {
+            time_to_target = train_seconds;
+        }
+
+        epochs.push_back({
+            { "epoch", epoch },
+            { "seconds", elapsed.count() },
+            { "test_accuracy", accuracy },
+        });
+    }
+
+    double samples_per_sec = static_cast<double>(TRAIN_SIZE) * args.max_epochs / train_seconds;
+    json allocations_per_batch = nullptr;
+    if (train_allocations) {
+        allocations_per_batch =
+            static_cast<double>(*train_allocations) / (batches_per_epoch * args.max_epochs);
+    }
+
+    json result = {
+        { "name", config.name() },
+        { "layer_sizes", config.topology.layer_sizes },
+        { "activations", activations },
+        { "loss", config.head.loss },
+        { "batch_size", config.batch_size },
+        { "threads", config.threads },
+        { "eigen_threads", Eigen::nbThreads() },
+        { "samples_per_sec", samples_per_sec },
+        { "time_to_target_sec", time_to_target ? json(*time_to_target) : json(nullptr) },
+        { "final_test_accuracy", epochs.back()["test_accuracy"] },
+        { "peak_rss_kib", peak_rss() },
+        { "allocations_per_batch", allocations_per_batch },
+        { "epochs", epochs },
+    };
+
+    spdlog::info(
+        "{}: {:.0f} samples/s, accuracy {:.4f}, {} allocations/batch", config.name(),
+        samples_per_sec, epochs.back()["test_accuracy"].get<double>(),
+        allocations_per_batch.dump()
+    );
+    return result;
+}
+
+int main(int argc, char** argv) {
+    CliArgs args = CliArgs::parse(argc, argv);
+
+    std::vector<BenchConfig> configs;
+    for (const auto& topology : TOPOLOGIES) {
+        for (const auto& hidden_activation : HIDDEN_ACTIVATIONS) {
+            for (const auto& head : HEADS) {
+                for (int batch_size : args.batch_sizes) {
+                    for (int threads : args.thread_counts) {
+                        BenchConfig config{
+                            topology, hidden_activation, head, batch_size, threads
+                        };
+                        if (!args.filter || config.name().contains(*args.filter)) {
+                            configs.push_back(config);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    MemMatrix train_inputs(args.train_inputs(), IMAGE_SIZE, TRAIN_SIZE);
+    MemMatrix train_labels(args.train_labels(), LABEL_SIZE, TRAIN_SIZE);
+    MemMatrix test_inputs(args.test_inputs(), IMAGE_SIZE, TEST_SIZE);
+    MemMatrix test_labels(args.test_labels(), LABEL_SIZE, TEST_SIZE);
+
+    Dataset data{ train_inputs.mat(), train_labels.mat(), test_inputs.mat(), {} };
+    data.test_labels.resize(TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; i++) {
+        test_labels.mat().col(i).maxCoeff(&data.test_labels[i]);
+    }
+
+    spdlog::info("Running {} configurations", configs.size());
+
+    json results = json::array();
+    for (const auto& config : configs) {
+        results.push_back(run_config(config, data, args));
+    }
+
+    json report = {
+        { "max_epochs", args.max_epochs },
+        { "target_accuracy", args.target_accuracy },
+        { "learning_rate", args.learning_rate },
+        { "seed", args.seed },
+        { "results", results },
+    };
+
+    std::ofstream out(args.output_path);
+    out << report.dump(2) << "\n";
+    if (!out) {
+        spdlog::error("Failed to write {}", args.output_path);
+        return 1;
+    }
+    spdlog::info("Wrote {}", args.output_path);
+}
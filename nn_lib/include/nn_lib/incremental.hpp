@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Eigen/Core>
+#include "nn_lib/network.hpp"
+
+namespace nn {
+
+// Feeds forward a stream of single inputs where each differs from the previous one in only a few
+// values, like a drawing being updated stroke by stroke. The first layer pre-activation W0 * x + b0
+// is kept between calls and only the columns of W0 for the changed inputs are applied to it, the
+// layers above are computed as usual. Outputs match feed_forward up to rounding. Not thread safe
+class IncrementalPredictor {
+public:
+    // Updates touching more than this fraction of the inputs recompute the first layer in full
+    static constexpr double MAX_CHANGED_FRACTION = 0.25;
+    // Incremental updates between full recomputes, bounds the accumulated rounding error
+    static constexpr int REFRESH_INTERVAL = 256;
+
+    // The network must outlive the predictor
+    explicit IncrementalPredictor(const Network& network);
+
+    // Output for a single input column
+    VectorXd predict(const VectorXd& input);
+    // Forgets the previous input, the next predict recomputes in full
+    void reset();
+
+    // Inputs that changed in the last predict, all of them when it recomputed in full
+    int last_changed() const;
+
+private:
+    void recompute(const VectorXd& input);
+
+    const Network& m_network;
+    VectorXd m_input;
+    VectorXd m_z0;
+    bool m_valid = false;
+    int m_updates = 0;
+    int m_last_changed = 0;
+};
+
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <functional>
 #include <optional>
+#include <span>
 #include <vector>
 #include "nn_lib/activation.hpp"
 #include "nn_lib/loss.hpp"
@@ -22,8 +24,29 @@ struct SGDHyperparams {
     int batch_size;
     // Window width for reporting average loss (in batches)
     std::optional<int> log_interval;
+    // Split every batch into chunks of at most this many samples and accumulate their
+    // gradients before a single weight update, so activation memory stays bounded by the
+    // micro batch while the effective batch size stays batch_size
+    std::optional<int> micro_batch_size;
 };
 
+// Combines the gradients of a batch with those of the other data-parallel replicas, in place.
+// The buffer holds every weight gradient, then every bias gradient, then the loss and the number
+// of samples, all summed over the local batch. After the call it must hold the sums over all
+// replicas, identical on every replica
+using GradientReducer = std::function<void(std::span<double> buffer)>;
+
+// Gradient of the loss with respect to the output layer pre-activations z, given the outputs a
+// and the targets y
+MatrixXd output_delta(
+    const OutputActivation& activation, const Loss& loss, const MatrixXd& z, const MatrixXd& a,
+    const MatrixXd& y
+);
+
+// Ensemble prediction: the element-wise mean of the outputs several networks gave for the same
+// inputs, e.g. their softmax probabilities. nullopt when outputs is empty or the shapes differ
+std::optional<MatrixXd> average_outputs(std::span<const MatrixXd> outputs);
+
 class Network {
 public:
     static std::optional<Network> from_data(
@@ -41,18 +64,40 @@ public:
     MatrixXd feed_forward(const MatrixXd& input) const;
     Prediction predict(const MatrixXd& x, const MatrixXd& y) const;
     double calculate_loss(const MatrixXd& x, const MatrixXd& y) const;
+    // Loss of already computed outputs a against the targets y, averaged over the columns
+    double output_loss(const MatrixXd& a, const MatrixXd& y) const;
 
     double learn(const MatrixXd& input, const MatrixXd& y, double learning_rate);
     std::optional<std::vector<double>> train_sgd(
         const Eigen::Ref<const Eigen::MatrixXd>& inputs,
         const Eigen::Ref<const Eigen::MatrixXd>& targets, const SGDHyperparams& hyperparams
     );
+    // Data-parallel variant, every replica must run the same number of batches per epoch
+    std::optional<std::vector<double>> train_sgd(
+        const Eigen::Ref<const Eigen::MatrixXd>& inputs,
+        const Eigen::Ref<const Eigen::MatrixXd>& targets, const SGDHyperparams& hyperparams,
+        const GradientReducer& reducer
+    );
     int evaluate_onehot(const MatrixXd& x, const std::vector<int>& labels) const;
 
+    struct Gradients {
+        std::vector<MatrixXd> dw;
+        std::vector<VectorXd> db;
+        double loss;
+    };
+    // Gradients and loss averaged over the columns of input
+    Gradients compute_gradients(const MatrixXd& input, const MatrixXd& y) const;
+
     std::vector<double> dump_weights();
     std::vector<double> dump_biases();
+    // Replaces the parameters with ones in the layout of dump_weights and dump_biases, false if
+    // their sizes do not match the network
+    bool load_parameters(const std::vector<double>& weights, const std::vector<double>& biases);
 
 private:
+    friend class SGDTrainer;
+    friend class IncrementalPredictor;
+
     Network(
         const std::vector<MatrixXd>& weights, const std::vector<VectorXd>& biases,
         const std::vector<HiddenActivation>& hidden_activations,
@@ -63,15 +108,16 @@ private:
         std::vector<MatrixXd> zs;
         std::vector<MatrixXd> as;
     };
-    struct Gradients {
-        std::vector<MatrixXd> dw;
-        std::vector<VectorXd> db;
-        double loss;
-    };
 
     FFResults feed_forward_train(const MatrixXd& input) const;
-    Gradients compute_gradients(const MatrixXd& input, const MatrixXd& y) const;
-    MatrixXd output_delta(const MatrixXd& z, const MatrixXd& a, const MatrixXd& y) const;
+    Gradients zero_gradients() const;
+    // Adds the gradients and loss summed (not averaged) over the columns of input to grads
+    void accumulate_gradients(const MatrixXd& input, const MatrixXd& y, Gradients& grads) const;
+    void apply_gradients(const Gradients& grads, double scale);
+    // Returns the number of samples the reduced gradients were summed over
+    int reduce_gradients(
+        Gradients& grads, int samples, const GradientReducer& reducer, std::vector<double>& buffer
+    ) const;
 
     static bool validate_inputs(
         const std::vector<int>& layer_sizes, const std::vector<double>& weights,
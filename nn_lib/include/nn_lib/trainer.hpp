@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "nn_lib/network.hpp"
+
+namespace nn {
+
+// Everything besides the network parameters needed to continue a training where it stopped. Plain
+// SGD keeps no optimizer state of its own
+struct SGDTrainerState {
+    int epoch;
+    // Samples of the epoch already trained on
+    int offset;
+    int64_t samples_seen;
+    // RNG state before the epoch was shuffled, as written by operator<<
+    std::string rng;
+};
+
+// Minibatch SGD that runs a few batches per call, so callers can interleave several trainings,
+// report progress or stop between steps. Running it to completion is the same as train_sgd
+class SGDTrainer {
+public:
+    // The network and the data must outlive the trainer
+    SGDTrainer(
+        Network& network, const Eigen::Ref<const MatrixXd>& inputs,
+        const Eigen::Ref<const MatrixXd>& targets, const SGDHyperparams& hyperparams,
+        const GradientReducer& reducer = {}
+    );
+
+    // Runs at most max_batches batches, fewer when training ends first. Returns the number run
+    int step(int max_batches);
+    bool done() const;
+
+    // Completed epochs
+    int epoch() const;
+    // Completed batches of the current epoch
+    int batch() const;
+    int batches_per_epoch() const;
+    int64_t samples_seen() const;
+    // Average loss of the batches run by the last step
+    double last_loss() const;
+
+    SGDTrainerState state() const;
+    // Continues from the state of a trainer over the same data and hyperparameters, with the
+    // network holding that trainer's parameters at the time. False if the state does not fit
+    bool restore(const SGDTrainerState& state);
+
+private:
+    void run_batch();
+    // Draws the sample order of the epoch that is starting
+    void shuffle();
+
+    Network& m_network;
+    Eigen::Ref<const MatrixXd> m_inputs;
+    Eigen::Ref<const MatrixXd> m_targets;
+    SGDHyperparams m_hyperparams;
+    GradientReducer m_reducer;
+    int m_micro_batch_size;
+
+    std::vector<int> m_indices;
+    std::mt19937 m_rng;
+    // m_rng before the current epoch was shuffled, the order is reset before every shuffle so this
+    // alone is enough to redraw it
+    std::mt19937 m_epoch_rng;
+
+    int m_epoch = 0;
+    // Samples of the current epoch already trained on
+    int m_offset = 0;
+    int64_t m_samples_seen = 0;
+    double m_last_loss = 0;
+
+    // Reused across batches, only the micro batch is ever materialized
+    Network::Gradients m_grads;
+    MatrixXd m_batch_inputs;
+    MatrixXd m_batch_targets;
+    std::vector<double> m_reduce_buffer;
+};
+
+}
@@ -0,0 +1,74 @@
+#include "nn_lib/incremental.hpp"
+#include <vector>
+
+namespace nn {
+
+IncrementalPredictor::IncrementalPredictor(const Network& network) : m_network(network) {}
+
+VectorXd IncrementalPredictor::predict(const VectorXd& input) {
+    const auto& W0 = m_network.m_weights.front();
+
+    std::vector<int> changed;
+    if (m_valid && m_updates < REFRESH_INTERVAL && input.size() == m_input.size()) {
+        auto max_changed = static_cast<size_t>(input.size() * MAX_CHANGED_FRACTION);
+        for (int i = 0; i < input.size() && changed.size() <= max_changed; i++) {
+            if (input(i) != m_input(i)) {
+                changed.push_back(i);
+            }
+        }
+        // A dense update costs about as much as the full product
+        if (changed.size() > max_changed) {
+            m_valid = false;
+        }
+    } else {
+        m_valid = false;
+    }
+
+    if (m_valid) {
+        for (int i : changed) {
+            m_z0 += W0.col(i) * (input(i) - m_input(i));
+            m_input(i) = input(i);
+        }
+        m_updates++;
+        m_last_changed = changed.size();
+    } else {
+        recompute(input);
+    }
+
+    // Feed forward the layers above the first one
+    const auto& hidden = m_network.m_hidden_activations;
+    if (hidden.empty()) {
+        return apply_activation(m_network.m_output_activation, m_z0);
+    }
+    MatrixXd out = apply_activation(hidden.front(), m_z0);
+    for (size_t i = 1; i < hidden.size(); i++) {
+        const auto& W = m_network.m_weights[i];
+        const auto& b = m_network.m_biases[i];
+        out = apply_activation(hidden[i], (W * out).colwise() + b);
+    }
+
+    // Feed forward the output layer
+    const auto& out_w = m_network.m_weights.back();
+    const auto& out_b = m_network.m_biases.back();
+    out = apply_activation(m_network.m_output_activation, (out_w * out).colwise() + out_b);
+
+    return out;
+}
+
+void IncrementalPredictor::reset() {
+    m_valid = false;
+}
+
+int IncrementalPredictor::last_changed() const {
+    return m_last_changed;
+}
+
+void IncrementalPredictor::recompute(const VectorXd& input) {
+    m_input = input;
+    m_z0 = m_network.m_weights.front() * input + m_network.m_biases.front();
+    m_valid = true;
+    m_updates = 0;
+    m_last_changed = input.size();
+}
+
+}
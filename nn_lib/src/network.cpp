@@ -5,6 +5,7 @@
 #include <ranges>
 #include "nn_lib/activation.hpp"
 #include "nn_lib/loss.hpp"
+#include "nn_lib/trainer.hpp"
 
 namespace nn {
 
@@ -142,14 +143,15 @@ MatrixXd Network::feed_forward(const MatrixXd& input) const {
 
 Prediction Network::predict(const MatrixXd& x, const MatrixXd& y) const {
     auto a = feed_forward(x);
-    double loss = std::visit([&](auto&& l) {
-        return l.function(a, y);
-    }, m_loss);
+    double loss = output_loss(a, y);
     return { a, loss };
 }
 
 double Network::calculate_loss(const MatrixXd& x, const MatrixXd& y) const {
-    auto a = feed_forward(x);
+    return output_loss(feed_forward(x), y);
+}
+
+double Network::output_loss(const MatrixXd& a, const MatrixXd& y) const {
     return std::visit([&](auto&& l) {
         return l.function(a, y);
     }, m_loss);
@@ -185,7 +187,25 @@ Network::FFResults Network::feed_forward_train(const MatrixXd& input) const {
     return res;
 }
 
-MatrixXd Network::output_delta(const MatrixXd& z, const MatrixXd& a, const MatrixXd& y) const {
+std::optional<MatrixXd> average_outputs(std::span<const MatrixXd> outputs) {
+    if (outputs.empty()) {
+        return std::nullopt;
+    }
+
+    MatrixXd sum = outputs.front();
+    for (const auto& output : outputs.subspan(1)) {
+        if (output.rows() != sum.rows() || output.cols() != sum.cols()) {
+            return std::nullopt;
+        }
+        sum += output;
+    }
+    return sum / static_cast<double>(outputs.size());
+}
+
+MatrixXd output_delta(
+    const OutputActivation& activation, const Loss& loss, const MatrixXd& z, const MatrixXd& a,
+    const MatrixXd& y
+) {
     return std::visit([&](const auto& act, const auto& loss) -> MatrixXd {
         using A = std::decay_t<decltype(act)>;
         using L = std::decay_t<decltype(loss)>;
@@ -208,24 +228,36 @@ MatrixXd Network::output_delta(const MatrixXd& z, const MatrixXd& a, const Matri
             auto da_dz = act.derivative(z);
             return dc_da.array() * da_dz.array();
         }
-    }, m_output_activation, m_loss);
+    }, activation, loss);
 }
 
-Network::Gradients Network::compute_gradients(const MatrixXd& input, const MatrixXd& y) const {
-    auto ff = feed_forward_train(input);
+Network::Gradients Network::zero_gradients() const {
     Gradients grads;
 
-    grads.dw.resize(m_weights.size());
-    grads.db.resize(m_biases.size());
+    grads.dw.reserve(m_weights.size());
+    grads.db.reserve(m_biases.size());
+    for (const auto& [W, b] : std::views::zip(m_weights, m_biases)) {
+        grads.dw.push_back(MatrixXd::Zero(W.rows(), W.cols()));
+        grads.db.push_back(VectorXd::Zero(b.size()));
+    }
+    grads.loss = 0;
+
+    return grads;
+}
+
+void Network::accumulate_gradients(
+    const MatrixXd& input, const MatrixXd& y, Gradients& grads
+) const {
+    auto ff = feed_forward_train(input);
 
-    grads.loss = std::visit([&](auto&& l) {
+    grads.loss += std::visit([&](auto&& l) {
         return l.function(ff.as.back(), y);
-    }, m_loss);
-    auto dz = output_delta(ff.zs.back(), ff.as.back(), y);
+    }, m_loss) * input.cols();
+    MatrixXd dz = output_delta(m_output_activation, m_loss, ff.zs.back(), ff.as.back(), y);
 
     for (ssize_t n = m_weights.size() - 1; n >= 0; n--) {
-        grads.dw[n] = (dz * ff.as[n].transpose()) / input.cols();
-        grads.db[n] = dz.rowwise().mean();
+        grads.dw[n].noalias() += dz * ff.as[n].transpose();
+        grads.db[n] += dz.rowwise().sum();
 
         if (n) {
             std::visit([&](const auto& act) {
@@ -234,61 +266,101 @@ Network::Gradients Network::compute_gradients(const MatrixXd& input, const Matri
             }, m_hidden_activations[n - 1]);
         }
     }
+}
+
+Network::Gradients Network::compute_gradients(const MatrixXd& input, const MatrixXd& y) const {
+    auto grads = zero_gradients();
+    accumulate_gradients(input, y, grads);
+
+    double samples = input.cols();
+    for (size_t i = 0; i < grads.dw.size(); ++i) {
+        grads.dw[i] /= samples;
+        grads.db[i] /= samples;
+    }
+    grads.loss /= samples;
 
     return grads;
 }
 
-double Network::learn(const MatrixXd& input, const MatrixXd& y, double learning_rate) {
-    auto grads = compute_gradients(input, y);
-
+void Network::apply_gradients(const Gradients& grads, double scale) {
     for (size_t i = 0; i < m_weights.size(); ++i) {
-        m_weights[i] -= learning_rate * grads.dw[i];
-        m_biases[i] -= learning_rate * grads.db[i];
+        m_weights[i] -= scale * grads.dw[i];
+        m_biases[i] -= scale * grads.db[i];
+    }
+}
+
+int Network::reduce_gradients(
+    Gradients& grads, int samples, const GradientReducer& reducer, std::vector<double>& buffer
+) const {
+    size_t size = 2;
+    for (const auto& [dw, db] : std::views::zip(grads.dw, grads.db)) {
+        size += dw.size() + db.size();
+    }
+    buffer.resize(size);
+
+    size_t offset = 0;
+    for (const auto& dw : grads.dw) {
+        MatrixXd::Map(buffer.data() + offset, dw.rows(), dw.cols()) = dw;
+        offset += dw.size();
+    }
+    for (const auto& db : grads.db) {
+        VectorXd::Map(buffer.data() + offset, db.size()) = db;
+        offset += db.size();
     }
+    buffer[offset] = grads.loss;
+    buffer[offset + 1] = samples;
+
+    reducer(buffer);
 
+    offset = 0;
+    for (auto& dw : grads.dw) {
+        dw = MatrixXd::Map(buffer.data() + offset, dw.rows(), dw.cols());
+        offset += dw.size();
+    }
+    for (auto& db : grads.db) {
+        db = VectorXd::Map(buffer.data() + offset, db.size());
+        offset += db.size();
+    }
+    grads.loss = buffer[offset];
+    return static_cast<int>(buffer[offset + 1]);
+}
+
+double Network::learn(const MatrixXd& input, const MatrixXd& y, double learning_rate) {
+    auto grads = compute_gradients(input, y);
+    apply_gradients(grads, learning_rate);
     return grads.loss;
 }
 
 std::optional<std::vector<double>> Network::train_sgd(
     const Eigen::Ref<const Eigen::MatrixXd>& inputs,
     const Eigen::Ref<const Eigen::MatrixXd>& targets, const SGDHyperparams& hyperparams
+) {
+    return train_sgd(inputs, targets, hyperparams, {});
+}
+
+std::optional<std::vector<double>> Network::train_sgd(
+    const Eigen::Ref<const Eigen::MatrixXd>& inputs,
+    const Eigen::Ref<const Eigen::MatrixXd>& targets, const SGDHyperparams& hyperparams,
+    const GradientReducer& reducer
 ) {
     std::vector<double> avg_losses;
     double avg_loss = 0;
     int loss_count = 0;
 
-    int num_samples = inputs.cols();
-    std::vector<int> indices(num_samples);
-    std::iota(indices.begin(), indices.end(), 0);
-    std::mt19937 g;
-
-    for (int epoch = 0; epoch < hyperparams.epochs; ++epoch) {
-        std::shuffle(indices.begin(), indices.end(), g);
+    SGDTrainer trainer(*this, inputs, targets, hyperparams, reducer);
+    while (!trainer.done()) {
+        trainer.step(1);
+        avg_loss += trainer.last_loss();
+        loss_count++;
 
-        for (int i = 0; i < num_samples; i += hyperparams.batch_size) {
-            int current_batch_size = std::min(hyperparams.batch_size, num_samples - i);
-            MatrixXd batch_inputs(inputs.rows(), current_batch_size);
-            MatrixXd batch_targets(targets.rows(), current_batch_size);
-
-            for (int j = 0; j < current_batch_size; ++j) {
-                int idx = indices[i + j];
-                batch_inputs.col(j) = inputs.col(idx);
-                batch_targets.col(j) = targets.col(idx);
-            }
-
-            avg_loss += learn(batch_inputs, batch_targets, hyperparams.learning_rate);
-            loss_count++;
-
-            if (!hyperparams.log_interval) {
-                continue;
-            }
-            auto log_interval = *hyperparams.log_interval;
-            if ((i / hyperparams.batch_size + 1) % log_interval == 0
-                || i + hyperparams.batch_size >= num_samples) {
-                avg_losses.push_back(avg_loss / loss_count);
-                avg_loss = 0;
-                loss_count = 0;
-            }
+        if (!hyperparams.log_interval) {
+            continue;
+        }
+        // batch() wraps to 0 at the end of an epoch, which always reports
+        if (trainer.batch() % *hyperparams.log_interval == 0) {
+            avg_losses.push_back(avg_loss / loss_count);
+            avg_loss = 0;
+            loss_count = 0;
         }
     }
 
@@ -335,4 +407,36 @@ std::vector<double> Network::dump_biases() {
     return dumped;
 }
 
+bool Network::load_parameters(
+    const std::vector<double>& weights, const std::vector<double>& biases
+) {
+    size_t weight_count = 0;
+    size_t bias_count = 0;
+    for (const auto& W : m_weights) {
+        weight_count += W.size();
+    }
+    for (const auto& b : m_biases) {
+        bias_count += b.size();
+    }
+    if (weights.size() != weight_count || biases.size() != bias_count) {
+        return false;
+    }
+
+    size_t weight_index = 0;
+    for (auto& W : m_weights) {
+        for (int r = 0; r < W.rows(); ++r) {
+            for (int c = 0; c < W.cols(); ++c) {
+                W(r, c) = weights[weight_index++];
+            }
+        }
+    }
+    size_t bias_index = 0;
+    for (auto& b : m_biases) {
+        for (int i = 0; i < b.size(); ++i) {
+            b(i) = biases[bias_index++];
+        }
+    }
+    return true;
+}
+
 }
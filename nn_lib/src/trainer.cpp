@@ -0,0 +1,149 @@
+#include "nn_lib/trainer.hpp"
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+
+namespace nn {
+
+SGDTrainer::SGDTrainer(
+    Network& network, const Eigen::Ref<const MatrixXd>& inputs,
+    const Eigen::Ref<const MatrixXd>& targets, const SGDHyperparams& hyperparams,
+    const GradientReducer& reducer
+)
+: m_network(network), m_inputs(inputs), m_targets(targets), m_hyperparams(hyperparams),
+  m_reducer(reducer),
+  m_micro_batch_size(std::clamp(
+      hyperparams.micro_batch_size.value_or(hyperparams.batch_size), 1, hyperparams.batch_size
+  )),
+  m_indices(inputs.cols()), m_grads(network.zero_gradients()),
+  m_batch_inputs(inputs.rows(), m_micro_batch_size),
+  m_batch_targets(targets.rows(), m_micro_batch_size) {
+    if (m_indices.empty()) {
+        m_epoch = m_hyperparams.epochs;
+    }
+    if (!done()) {
+        shuffle();
+    }
+}
+
+void SGDTrainer::shuffle() {
+    m_epoch_rng = m_rng;
+    std::iota(m_indices.begin(), m_indices.end(), 0);
+    std::shuffle(m_indices.begin(), m_indices.end(), m_rng);
+}
+
+int SGDTrainer::step(int max_batches) {
+    double total_loss = 0;
+    int batches = 0;
+    while (batches < max_batches && !done()) {
+        run_batch();
+        total_loss += m_last_loss;
+        batches++;
+    }
+    if (batches > 0) {
+        m_last_loss = total_loss / batches;
+    }
+    return batches;
+}
+
+void SGDTrainer::run_batch() {
+    int num_samples = m_indices.size();
+    int current_batch_size = std::min(m_hyperparams.batch_size, num_samples - m_offset);
+
+    for (size_t n = 0; n < m_grads.dw.size(); ++n) {
+        m_grads.dw[n].setZero();
+        m_grads.db[n].setZero();
+    }
+    m_grads.loss = 0;
+
+    for (int m = 0; m < current_batch_size; m += m_micro_batch_size) {
+        int current_micro_size = std::min(m_micro_batch_size, current_batch_size - m);
+        m_batch_inputs.resize(Eigen::NoChange, current_micro_size);
+        m_batch_targets.resize(Eigen::NoChange, current_micro_size);
+
+        for (int j = 0; j < current_micro_size; ++j) {
+            int idx = m_indices[m_offset + m + j];
+            m_batch_inputs.col(j) = m_inputs.col(idx);
+            m_batch_targets.col(j) = m_targets.col(idx);
+        }
+
+        m_network.accumulate_gradients(m_batch_inputs, m_batch_targets, m_grads);
+    }
+
+    int batch_samples = current_batch_size;
+    if (m_reducer) {
+        batch_samples = m_network.reduce_gradients(
+            m_grads, current_batch_size, m_reducer, m_reduce_buffer
+        );
+    }
+
+    m_network.apply_gradients(m_grads, m_hyperparams.learning_rate / batch_samples);
+    m_last_loss = m_grads.loss / batch_samples;
+    m_samples_seen += current_batch_size;
+
+    m_offset += current_batch_size;
+    if (m_offset >= num_samples) {
+        m_offset = 0;
+        m_epoch++;
+        if (!done()) {
+            shuffle();
+        }
+    }
+}
+
+bool SGDTrainer::done() const {
+    return m_epoch >= m_hyperparams.epochs;
+}
+
+int SGDTrainer::epoch() const {
+    return m_epoch;
+}
+
+int SGDTrainer::batch() const {
+    return (m_offset + m_hyperparams.batch_size - 1) / m_hyperparams.batch_size;
+}
+
+int SGDTrainer::batches_per_epoch() const {
+    int num_samples = m_indices.size();
+    return (num_samples + m_hyperparams.batch_size - 1) / m_hyperparams.batch_size;
+}
+
+int64_t SGDTrainer::samples_seen() const {
+    return m_samples_seen;
+}
+
+double SGDTrainer::last_loss() const {
+    return m_last_loss;
+}
+
+SGDTrainerState SGDTrainer::state() const {
+    std::ostringstream rng;
+    rng << m_epoch_rng;
+    return SGDTrainerState{ m_epoch, m_offset, m_samples_seen, rng.str() };
+}
+
+bool SGDTrainer::restore(const SGDTrainerState& state) {
+    int num_samples = m_indices.size();
+    if (state.epoch < 0 || state.epoch > m_hyperparams.epochs || state.offset < 0
+        || state.offset >= std::max(num_samples, 1)) {
+        return false;
+    }
+
+    std::mt19937 rng;
+    std::istringstream rng_stream(state.rng);
+    rng_stream >> rng;
+    if (!rng_stream) {
+        return false;
+    }
+
+    m_epoch = state.epoch;
+    m_offset = state.offset;
+    m_samples_seen = state.samples_seen;
+    m_rng = rng;
+    if (!done()) {
+        shuffle();
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+struct CliArgs {
+    static CliArgs parse(int argc, char** argv);
+
+    // Load from the server database
+    std::optional<std::string> db_path;
+    std::optional<int> network_id;
+
+    // Load from raw files as written by Network::dump_weights/dump_biases
+    std::optional<std::string> weights_path;
+    std::optional<std::string> biases_path;
+    std::vector<int> layer_sizes;
+    std::vector<std::string> activations;
+
+    std::string scalar_type;
+    std::string namespace_name;
+    std::optional<std::string> output_path;
+};
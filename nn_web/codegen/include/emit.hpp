@@ -0,0 +1,16 @@
+#pragma once
+
+#include <expected>
+#include <string>
+#include "model.hpp"
+
+struct EmitOptions {
+    // "float" or "double"
+    std::string scalar_type;
+    std::string namespace_name;
+};
+
+// Emits a self contained header with the weights as constexpr arrays and an infer() function
+// specialized for the model's exact topology
+std::expected<std::string, std::string>
+    emit_header(const Model& model, const EmitOptions& options);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <expected>
+#include <string>
+#include <vector>
+
+struct Model {
+    std::string name;
+    std::vector<int> layer_sizes;
+    // Row major per layer, in the order produced by Network::dump_weights
+    std::vector<double> weights;
+    std::vector<double> biases;
+    // One per non-input layer, the last one is the output activation
+    std::vector<std::string> activations;
+};
+
+std::expected<Model, std::string> load_model_from_db(const std::string& db_path, int id);
+std::expected<Model, std::string> load_model_from_files(
+    const std::string& weights_path, const std::string& biases_path,
+    const std::vector<int>& layer_sizes, const std::vector<std::string>& activations
+);
+
+// Checks that the weights fit the topology and that the activations are known
+std::expected<void, std::string> validate_model(const Model& model);
@@ -0,0 +1,95 @@
+#include "cli.hpp"
+#include <cctype>
+#include <print>
+#include <ranges>
+#include <string_view>
+
+void print_usage_and_exit() {
+    std::println("Usage: nn_codegen --db <db_file> --id <network_id> [options]");
+    std::println(
+        "       nn_codegen --weights <file> --biases <file> --layers <sizes> "
+        "--activations <names> [options]"
+    );
+    std::println("  --type <float|double>    Scalar type of the generated code (default: float)");
+    std::println("  --namespace <name>       Namespace of the generated code (default: model)");
+    std::println("  --output <file>          Header to write (default: stdout)");
+    std::exit(1);
+}
+
+// An identifier or identifiers joined by ::, as accepted by a namespace definition
+bool is_namespace_name(std::string_view name) {
+    if (name.empty()) {
+        return false;
+    }
+    for (auto part : name | std::views::split(std::string_view("::"))) {
+        std::string_view identifier(part.begin(), part.end());
+        if (identifier.empty() || std::isdigit(static_cast<unsigned char>(identifier.front()))) {
+            return false;
+        }
+        for (char c : identifier) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+CliArgs CliArgs::parse(int argc, char** argv) {
+    CliArgs args;
+    args.scalar_type = "float";
+    args.namespace_name = "model";
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i == argc - 1) {
+                    print_usage_and_exit();
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--db") {
+                args.db_path = value();
+            } else if (arg == "--id") {
+                args.network_id = std::stoi(value());
+            } else if (arg == "--weights") {
+                args.weights_path = value();
+            } else if (arg == "--biases") {
+                args.biases_path = value();
+            } else if (arg == "--layers") {
+                for (auto part : value() | std::views::split(',')) {
+                    args.layer_sizes.push_back(std::stoi(std::string(part.begin(), part.end())));
+                }
+            } else if (arg == "--activations") {
+                for (auto part : value() | std::views::split(',')) {
+                    args.activations.emplace_back(part.begin(), part.end());
+                }
+            } else if (arg == "--type") {
+                args.scalar_type = value();
+            } else if (arg == "--namespace") {
+                args.namespace_name = value();
+            } else if (arg == "--output") {
+                args.output_path = value();
+            } else {
+                print_usage_and_exit();
+            }
+        }
+    } catch (const std::exception&) {
+        print_usage_and_exit();
+    }
+
+    bool from_db = args.db_path && args.network_id;
+    bool from_files = args.weights_path && args.biases_path && !args.layer_sizes.empty()
+                      && !args.activations.empty();
+    if (from_db == from_files) {
+        print_usage_and_exit();
+    }
+    if (!is_namespace_name(args.namespace_name)) {
+        std::println("Invalid namespace name: {}", args.namespace_name);
+        print_usage_and_exit();
+    }
+
+    return args;
+}
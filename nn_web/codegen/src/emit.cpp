@@ -0,0 +1,193 @@
+#include "emit.hpp"
+#include <cmath>
+#include <format>
+#include <iterator>
+#include <string_view>
+
+namespace {
+
+std::string format_scalar(double value, bool is_float) {
+    std::string s = is_float ? std::format("{}", static_cast<float>(value))
+                             : std::format("{}", value);
+    // Shortest round trip formatting may drop the decimal point, which would make it an integer
+    // literal (and "1f" is not a valid literal at all)
+    if (s.find_first_of(".e") == std::string::npos) {
+        s += ".0";
+    }
+    if (is_float) {
+        s += "f";
+    }
+    return s;
+}
+
+void emit_values(std::string& out, const double* values, int count, bool is_float) {
+    const int per_line = 8;
+    for (int i = 0; i < count; i++) {
+        if (i % per_line == 0) {
+            out += "\n        ";
+        } else {
+            out += " ";
+        }
+        out += format_scalar(values[i], is_float);
+        out += ",";
+    }
+}
+
+// The network name as it appears quoted in the header comment. Quotes, backslashes and control
+// characters are escaped, so a name can neither end the comment line nor continue it
+std::string escape_name(std::string_view name) {
+    std::string escaped;
+    for (char c : name) {
+        auto u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (u < 0x20 || u == 0x7f) {
+            escaped += std::format("\\x{:02x}", u);
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// Applies the activation in place to the array named var
+void emit_activation(std::string& out, const std::string& activation, const std::string& var) {
+    auto o = std::back_inserter(out);
+    if (activation == "relu") {
+        std::format_to(o, "    for (auto& v : {}) {{\n", var);
+        std::format_to(o, "        v = v > scalar(0) ? v : scalar(0);\n");
+        std::format_to(o, "    }}\n");
+    } else if (activation == "sigmoid") {
+        std::format_to(o, "    for (auto& v : {}) {{\n", var);
+        std::format_to(o, "        v = scalar(1) / (scalar(1) + std::exp(-v));\n");
+        std::format_to(o, "    }}\n");
+    } else if (activation == "softmax") {
+        std::format_to(o, "    {{\n");
+        std::format_to(o, "        scalar max = {}[0];\n", var);
+        std::format_to(o, "        for (auto v : {}) {{\n", var);
+        std::format_to(o, "            max = v > max ? v : max;\n");
+        std::format_to(o, "        }}\n");
+        std::format_to(o, "        scalar sum = 0;\n");
+        std::format_to(o, "        for (auto& v : {}) {{\n", var);
+        std::format_to(o, "            v = std::exp(v - max);\n");
+        std::format_to(o, "            sum += v;\n");
+        std::format_to(o, "        }}\n");
+        std::format_to(o, "        for (auto& v : {}) {{\n", var);
+        std::format_to(o, "            v /= sum;\n");
+        std::format_to(o, "        }}\n");
+        std::format_to(o, "    }}\n");
+    }
+    // linear is the identity
+}
+
+}
+
+std::expected<std::string, std::string>
+    emit_header(const Model& model, const EmitOptions& options) {
+    if (options.scalar_type != "float" && options.scalar_type != "double") {
+        return std::unexpected("Scalar type must be float or double");
+    }
+    bool is_float = options.scalar_type == "float";
+
+    // Checked in the emitted type, as weights beyond the float range turn into inf when narrowed
+    auto finite = [&](double v) {
+        return is_float ? std::isfinite(static_cast<float>(v)) : std::isfinite(v);
+    };
+    for (double v : model.weights) {
+        if (!finite(v)) {
+            return std::unexpected(
+                "Network has weights not representable as " + options.scalar_type
+            );
+        }
+    }
+    for (double v : model.biases) {
+        if (!finite(v)) {
+            return std::unexpected(
+                "Network has biases not representable as " + options.scalar_type
+            );
+        }
+    }
+
+    std::string out;
+    auto o = std::back_inserter(out);
+    int layers = model.layer_sizes.size() - 1;
+
+    std::format_to(
+        o, "// Generated by nn_codegen from network \"{}\", do not edit\n", escape_name(model.name)
+    );
+    std::format_to(o, "#pragma once\n\n");
+    std::format_to(o, "#include <array>\n#include <cmath>\n#include <cstddef>\n\n");
+    std::format_to(o, "namespace {} {{\n\n", options.namespace_name);
+    std::format_to(o, "using scalar = {};\n\n", options.scalar_type);
+    std::format_to(o, "inline constexpr std::size_t input_size = {};\n", model.layer_sizes.front());
+    std::format_to(
+        o, "inline constexpr std::size_t output_size = {};\n\n", model.layer_sizes.back()
+    );
+
+    std::format_to(o, "namespace detail {{\n\n");
+    size_t weight_offset = 0;
+    size_t bias_offset = 0;
+    for (int l = 0; l < layers; l++) {
+        int rows = model.layer_sizes[l + 1];
+        int cols = model.layer_sizes[l];
+
+        std::format_to(o, "inline constexpr scalar w{}[{}][{}] = {{", l, rows, cols);
+        for (int r = 0; r < rows; r++) {
+            std::format_to(o, "\n    {{");
+            emit_values(out, model.weights.data() + weight_offset, cols, is_float);
+            std::format_to(o, "\n    }},");
+            weight_offset += cols;
+        }
+        std::format_to(o, "\n}};\n\n");
+
+        std::format_to(o, "inline constexpr scalar b{}[{}] = {{", l, rows);
+        emit_values(out, model.biases.data() + bias_offset, rows, is_float);
+        std::format_to(o, "\n}};\n\n");
+        bias_offset += rows;
+    }
+    std::format_to(o, "}}\n\n");
+
+    std::format_to(
+        o, "inline std::array<scalar, output_size> infer(const std::array<scalar, input_size>& "
+           "input) {{\n"
+    );
+    std::string prev = "input";
+    for (int l = 0; l < layers; l++) {
+        int rows = model.layer_sizes[l + 1];
+        int cols = model.layer_sizes[l];
+        std::string var = std::format("a{}", l);
+
+        std::format_to(
+            o, "    // Layer {}: {} -> {}, {}\n", l + 1, cols, rows, model.activations[l]
+        );
+        std::format_to(o, "    std::array<scalar, {}> {};\n", rows, var);
+        std::format_to(o, "    for (std::size_t r = 0; r < {}; ++r) {{\n", rows);
+        std::format_to(o, "        scalar z = detail::b{}[r];\n", l);
+        std::format_to(o, "        for (std::size_t c = 0; c < {}; ++c) {{\n", cols);
+        std::format_to(o, "            z += detail::w{}[r][c] * {}[c];\n", l, prev);
+        std::format_to(o, "        }}\n");
+        std::format_to(o, "        {}[r] = z;\n", var);
+        std::format_to(o, "    }}\n");
+        emit_activation(out, model.activations[l], var);
+        std::format_to(o, "\n");
+        prev = var;
+    }
+    std::format_to(o, "    return {};\n", prev);
+    std::format_to(o, "}}\n\n");
+
+    std::format_to(o, "// Index of the highest output\n");
+    std::format_to(
+        o, "inline std::size_t predict(const std::array<scalar, input_size>& input) {{\n"
+    );
+    std::format_to(o, "    auto out = infer(input);\n");
+    std::format_to(o, "    std::size_t best = 0;\n");
+    std::format_to(o, "    for (std::size_t i = 1; i < output_size; ++i) {{\n");
+    std::format_to(o, "        best = out[i] > out[best] ? i : best;\n");
+    std::format_to(o, "    }}\n");
+    std::format_to(o, "    return best;\n");
+    std::format_to(o, "}}\n\n");
+
+    std::format_to(o, "}}\n");
+    return out;
+}
@@ -0,0 +1,45 @@
+#include <fstream>
+#include <iostream>
+#include "cli.hpp"
+#include "emit.hpp"
+#include "model.hpp"
+#include "spdlog/spdlog.h"
+
+int main(int argc, char** argv) {
+    CliArgs args = CliArgs::parse(argc, argv);
+
+    auto model = args.db_path ? load_model_from_db(*args.db_path, *args.network_id)
+                              : load_model_from_files(
+                                    *args.weights_path, *args.biases_path, args.layer_sizes,
+                                    args.activations
+                                );
+    if (!model) {
+        spdlog::error("Failed to load network: {}", model.error());
+        return 1;
+    }
+
+    auto valid = validate_model(*model);
+    if (!valid) {
+        spdlog::error("Invalid network: {}", valid.error());
+        return 1;
+    }
+
+    auto header = emit_header(*model, { args.scalar_type, args.namespace_name });
+    if (!header) {
+        spdlog::error("Failed to generate code: {}", header.error());
+        return 1;
+    }
+
+    if (!args.output_path) {
+        std::cout << *header;
+        return 0;
+    }
+
+    std::ofstream out(*args.output_path);
+    out << *header;
+    if (!out) {
+        spdlog::error("Failed to write {}", *args.output_path);
+        return 1;
+    }
+    spdlog::info("Wrote {}", *args.output_path);
+}
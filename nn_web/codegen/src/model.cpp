@@ -0,0 +1,138 @@
+#include "model.hpp"
+#include <sqlite3.h>
+#include <cstring>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <nn_lib/network.hpp>
+#include <ranges>
+
+std::expected<Model, std::string> load_model_from_db(const std::string& db_path, int id) {
+    sqlite3* db;
+    if (sqlite3_open_v2(db_path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        sqlite3_close(db);
+        return std::unexpected("Failed to open database: " + db_path);
+    }
+
+    const char* sql = R"(
+    SELECT name, layer_sizes, weights, biases, activations FROM networks WHERE id = ?;)";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::string error = "Failed to prepare query: ";
+        error += sqlite3_errmsg(db);
+        sqlite3_close(db);
+        return std::unexpected(error);
+    }
+    sqlite3_bind_int(stmt, 1, id);
+
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_ROW) {
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        if (rc == SQLITE_DONE) {
+            return std::unexpected("Network with id " + std::to_string(id) + " not found");
+        }
+        return std::unexpected(std::string("Failed to read network: ") + sqlite3_errstr(rc));
+    }
+
+    // NULL columns read as empty strings, which fail to parse below
+    auto column_text = [&](int col) {
+        auto text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+        return std::string(text ? text : "");
+    };
+
+    Model model;
+    model.name = column_text(0);
+    std::string layer_sizes_str = column_text(1);
+
+    const void* weights_blob = sqlite3_column_blob(stmt, 2);
+    int weights_size = sqlite3_column_bytes(stmt, 2);
+    model.weights.resize(weights_size / sizeof(double));
+    std::memcpy(model.weights.data(), weights_blob, model.weights.size() * sizeof(double));
+
+    const void* biases_blob = sqlite3_column_blob(stmt, 3);
+    int biases_size = sqlite3_column_bytes(stmt, 3);
+    model.biases.resize(biases_size / sizeof(double));
+    std::memcpy(model.biases.data(), biases_blob, model.biases.size() * sizeof(double));
+
+    std::string activations_str = column_text(4);
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    try {
+        model.layer_sizes = nlohmann::json::parse(layer_sizes_str).get<std::vector<int>>();
+        model.activations = nlohmann::json::parse(activations_str).get<std::vector<std::string>>();
+    } catch (const nlohmann::json::exception& e) {
+        return std::unexpected(std::string("Invalid network definition: ") + e.what());
+    }
+    return model;
+}
+
+std::expected<std::vector<double>, std::string> read_doubles(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return std::unexpected("Failed to open file: " + path);
+    }
+
+    auto size = static_cast<size_t>(file.tellg());
+    if (size % sizeof(double) != 0) {
+        return std::unexpected("File size is not a multiple of sizeof(double): " + path);
+    }
+
+    std::vector<double> data(size / sizeof(double));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), size);
+    if (!file) {
+        return std::unexpected("Error reading data in file " + path);
+    }
+    return data;
+}
+
+std::expected<Model, std::string> load_model_from_files(
+    const std::string& weights_path, const std::string& biases_path,
+    const std::vector<int>& layer_sizes, const std::vector<std::string>& activations
+) {
+    auto weights = read_doubles(weights_path);
+    if (!weights) {
+        return std::unexpected(weights.error());
+    }
+    auto biases = read_doubles(biases_path);
+    if (!biases) {
+        return std::unexpected(biases.error());
+    }
+
+    Model model;
+    model.name = weights_path;
+    model.layer_sizes = layer_sizes;
+    model.weights = std::move(weights.value());
+    model.biases = std::move(biases.value());
+    model.activations = activations;
+    return model;
+}
+
+std::expected<void, std::string> validate_model(const Model& model) {
+    if (model.activations.empty() || model.activations.size() + 1 != model.layer_sizes.size()) {
+        return std::unexpected("Number of activations must be one less than number of layers");
+    }
+
+    auto hidden_activations_view =
+        model.activations | std::views::take(model.activations.size() - 1);
+    auto hidden_activations = nn::strs_to_hidden_activation(hidden_activations_view);
+    if (!hidden_activations) {
+        return std::unexpected("Invalid activation functions in hidden layers");
+    }
+    auto output_activation = nn::str_to_output_activation(model.activations.back());
+    if (!output_activation) {
+        return std::unexpected("Invalid activation function in output layer");
+    }
+
+    // The loss does not matter for inference, from_data is only used for its shape checks
+    auto network = nn::Network::from_data(
+        model.layer_sizes, model.weights, model.biases, *hidden_activations, *output_activation,
+        nn::loss::MSE{}
+    );
+    if (!network) {
+        return std::unexpected("Weights and biases do not match the layer sizes");
+    }
+    return {};
+}
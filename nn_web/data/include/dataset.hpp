@@ -0,0 +1,6 @@
+#pragma once
+
+const int TRAIN_SIZE = 60000;
+const int TEST_SIZE = 10000;
+const int IMAGE_SIZE = 28 * 28;
+const int LABEL_SIZE = 10;
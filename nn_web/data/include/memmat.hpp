@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include "Eigen/Core"
+
+struct MemMatrix {
+    MemMatrix(const std::string& path, int rows, int cols);
+    // Maps only the columns [first_col, first_col + num_cols) of a file holding a rows x cols
+    // matrix, the rest of the file is never mapped
+    MemMatrix(const std::string& path, int rows, int cols, int first_col, int num_cols);
+    ~MemMatrix();
+
+    Eigen::Map<const Eigen::MatrixXd> mat() const;
+
+    // Reads the whole mapping into memory ahead of use, so the first pass over the data does not
+    // stall on page faults. Blocks until done, returns the number of bytes mapped
+    size_t prefault() const;
+
+private:
+    int m_fd;
+    void* m_addr;
+    size_t m_size;
+    const double* m_data;
+    int m_rows;
+    int m_cols;
+};
@@ -0,0 +1,75 @@
+#include "memmat.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <stdexcept>
+
+MemMatrix::MemMatrix(const std::string& path, int rows, int cols)
+: MemMatrix(path, rows, cols, 0, cols) {
+}
+
+MemMatrix::MemMatrix(const std::string& path, int rows, int cols, int first_col, int num_cols)
+: m_rows(rows), m_cols(num_cols) {
+    if (first_col < 0 || num_cols < 0 || first_col + num_cols > cols) {
+        throw std::runtime_error("Column range out of bounds: " + path);
+    }
+
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd == -1) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    struct stat sb;
+    if (fstat(m_fd, &sb) == -1) {
+        close(m_fd);
+        throw std::runtime_error("Failed to get file size: " + path);
+    }
+
+    size_t expected_size = static_cast<size_t>(rows) * cols * sizeof(double);
+    if (static_cast<size_t>(sb.st_size) != expected_size) {
+        close(m_fd);
+        throw std::runtime_error("File size does not match expected matrix size");
+    }
+
+    // mmap offsets have to be page aligned, so map from the page containing the first column
+    size_t begin = static_cast<size_t>(first_col) * rows * sizeof(double);
+    size_t end = begin + static_cast<size_t>(num_cols) * rows * sizeof(double);
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t map_begin = begin - begin % page_size;
+    m_size = std::max(end - map_begin, size_t{ 1 });
+
+    m_addr = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, static_cast<off_t>(map_begin));
+    if (m_addr == MAP_FAILED) {
+        close(m_fd);
+        throw std::runtime_error("mmap failed");
+    }
+
+    madvise(m_addr, m_size, MADV_SEQUENTIAL);
+    m_data = reinterpret_cast<const double*>(static_cast<const char*>(m_addr) + begin - map_begin);
+}
+
+MemMatrix::~MemMatrix() {
+    if (m_addr) {
+        munmap(m_addr, m_size);
+    }
+    if (m_fd != -1) {
+        close(m_fd);
+    }
+}
+
+size_t MemMatrix::prefault() const {
+    madvise(m_addr, m_size, MADV_WILLNEED);
+    // WILLNEED only starts the readahead, touching every page waits for it and maps the pages
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    auto bytes = static_cast<const volatile char*>(m_addr);
+    for (size_t offset = 0; offset < m_size; offset += page_size) {
+        static_cast<void>(bytes[offset]);
+    }
+    return m_size;
+}
+
+Eigen::Map<const Eigen::MatrixXd> MemMatrix::mat() const {
+    return Eigen::Map<const Eigen::MatrixXd>(m_data, m_rows, m_cols);
+}
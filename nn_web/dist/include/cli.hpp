@@ -0,0 +1,45 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "socket.hpp"
+
+enum class Mode { Coordinator, Worker };
+
+struct CliArgs {
+    static CliArgs parse(int argc, char** argv);
+
+    std::string train_inputs() const {
+        return data_dir + "/train_inputs.bin";
+    }
+    std::string train_labels() const {
+        return data_dir + "/train_labels.bin";
+    }
+    std::string test_inputs() const {
+        return data_dir + "/test_inputs.bin";
+    }
+    std::string test_labels() const {
+        return data_dir + "/test_labels.bin";
+    }
+
+    Mode mode;
+    Address listen;
+    std::string data_dir;
+
+    // Worker only
+    std::optional<Address> coordinator;
+
+    // Coordinator only
+    int workers;
+    bool spawn;
+    std::vector<int> layer_sizes;
+    std::vector<std::string> activations;
+    std::string loss;
+    int epochs;
+    int batch_size;
+    std::optional<int> micro_batch_size;
+    double learning_rate;
+    unsigned seed;
+    std::optional<std::string> output;
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "cli.hpp"
+
+// Assigns ranks in registration order, broadcasts the initial weights and collects the trained
+// network from rank 0
+int run_coordinator(const CliArgs& args);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "socket.hpp"
+
+// Sent by the coordinator to every worker once all of them have registered
+struct TrainSetup {
+    int rank;
+    int world_size;
+    // Columns of the training set owned by this worker
+    int shard_begin;
+    int shard_size;
+
+    int epochs;
+    int batch_size;
+    double learning_rate;
+    std::optional<int> micro_batch_size;
+
+    std::vector<int> layer_sizes;
+    std::vector<std::string> activations;
+    std::string loss;
+    std::vector<double> weights;
+    std::vector<double> biases;
+
+    // Listening address of rank + 1
+    std::string next_address;
+
+    void write(Socket& sock) const;
+    static TrainSetup read(Socket& sock);
+};
+
+// Sent back by every worker when training finishes, only rank 0 includes the weights
+struct TrainResult {
+    std::vector<double> losses;
+    std::vector<double> weights;
+    std::vector<double> biases;
+
+    void write(Socket& sock) const;
+    static TrainResult read(Socket& sock);
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include "socket.hpp"
+
+// Sums a buffer across all ranks of a ring. Each rank sends to rank + 1 and receives from
+// rank - 1, so every link carries 2 * (N - 1) / N of the buffer regardless of the world size
+class RingAllReduce {
+public:
+    RingAllReduce(int rank, int world_size, Socket next, Socket prev);
+
+    void operator()(std::span<double> buffer);
+
+private:
+    std::span<double> chunk(std::span<double> buffer, int index) const;
+
+    int m_rank;
+    int m_world_size;
+    Socket m_next;
+    Socket m_prev;
+    std::vector<double> m_scratch;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Either "unix:<path>" or "tcp:<host>:<port>"
+struct Address {
+    enum class Kind { Unix, Tcp };
+
+    static std::expected<Address, std::string> parse(std::string_view s);
+    std::string str() const;
+
+    Kind kind;
+    std::string path;
+    std::string host;
+    int port = 0;
+};
+
+class Socket {
+public:
+    Socket() = default;
+    explicit Socket(int fd);
+    ~Socket();
+
+    Socket(Socket&& other) noexcept;
+    Socket& operator=(Socket&& other) noexcept;
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    int fd() const {
+        return m_fd;
+    }
+
+    void send_all(const void* data, size_t size);
+    void recv_all(void* data, size_t size);
+
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    void send_value(const T& value) {
+        send_all(&value, sizeof(T));
+    }
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    T recv_value() {
+        T value;
+        recv_all(&value, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    void send_vector(const std::vector<T>& v) {
+        send_value<uint64_t>(v.size());
+        send_all(v.data(), v.size() * sizeof(T));
+    }
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    std::vector<T> recv_vector() {
+        std::vector<T> v(recv_value<uint64_t>());
+        recv_all(v.data(), v.size() * sizeof(T));
+        return v;
+    }
+
+    void send_string(std::string_view s);
+    std::string recv_string();
+
+private:
+    int m_fd = -1;
+};
+
+Socket listen_on(const Address& address);
+// Retries for a few seconds so peers may be started in any order
+Socket connect_to(const Address& address);
+Socket accept_from(const Socket& listener);
+
+// Sends and receives at the same time so two peers exchanging large buffers cannot deadlock on
+// full socket buffers
+void exchange(
+    Socket& send_to, std::span<const std::byte> send, Socket& recv_from, std::span<std::byte> recv
+);
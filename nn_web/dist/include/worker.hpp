@@ -0,0 +1,5 @@
+#pragma once
+
+#include "cli.hpp"
+
+int run_worker(const CliArgs& args);
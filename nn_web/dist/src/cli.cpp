@@ -0,0 +1,132 @@
+#include "cli.hpp"
+#include <print>
+#include <ranges>
+#include <string_view>
+
+void print_usage_and_exit() {
+    std::println("Usage: nn_dist coordinator --listen <addr> [options]");
+    std::println("       nn_dist worker --coordinator <addr> --listen <addr> [--data <data_dir>]");
+    std::println("Addresses are unix:<path> or tcp:<host>:<port>");
+    std::println("  --data <data_dir>        Preprocessed dataset directory (default: mnist_data)");
+    std::println("  --workers <n>            Number of workers to wait for (default: 1)");
+    std::println("  --spawn                  Fork the workers on this machine");
+    std::println("  --layers <sizes>         Comma separated layer sizes (default: 784,128,10)");
+    std::println("  --activations <names>    Non-input layer activations (default: relu,softmax)");
+    std::println("  --loss <name>            Loss function (default: cross_entropy)");
+    std::println("  --epochs <n>             Number of epochs (default: 1)");
+    std::println("  --batch-size <n>         Global batch size split across workers (default: 32)");
+    std::println("  --micro-batch-size <n>   Per worker micro batch size");
+    std::println("  --learning-rate <lr>     Learning rate (default: 0.01)");
+    std::println("  --seed <n>               Seed for the initial weights (default: 0)");
+    std::println("  --output <prefix>        Write <prefix>.weights.bin and <prefix>.biases.bin");
+    std::exit(1);
+}
+
+template<typename T>
+std::vector<T> split_list(std::string_view s, auto&& convert) {
+    std::vector<T> values;
+    for (auto part : s | std::views::split(',')) {
+        values.push_back(convert(std::string(part.begin(), part.end())));
+    }
+    return values;
+}
+
+CliArgs CliArgs::parse(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage_and_exit();
+    }
+
+    CliArgs args;
+    if (std::string_view{ argv[1] } == "coordinator") {
+        args.mode = Mode::Coordinator;
+    } else if (std::string_view{ argv[1] } == "worker") {
+        args.mode = Mode::Worker;
+    } else {
+        print_usage_and_exit();
+    }
+
+    args.data_dir = "mnist_data";
+    args.workers = 1;
+    args.spawn = false;
+    args.layer_sizes = { 784, 128, 10 };
+    args.activations = { "relu", "softmax" };
+    args.loss = "cross_entropy";
+    args.epochs = 1;
+    args.batch_size = 32;
+    args.learning_rate = 0.01;
+    args.seed = 0;
+
+    bool has_listen = false;
+    try {
+        for (int i = 2; i < argc; i++) {
+            std::string_view arg = argv[i];
+            auto value = [&]() -> std::string_view {
+                if (i == argc - 1) {
+                    print_usage_and_exit();
+                }
+                return argv[++i];
+            };
+            auto address = [&]() -> Address {
+                auto res = Address::parse(value());
+                if (!res) {
+                    std::println("{}", res.error());
+                    print_usage_and_exit();
+                }
+                return res.value();
+            };
+
+            if (arg == "--listen") {
+                args.listen = address();
+                has_listen = true;
+            } else if (arg == "--coordinator") {
+                args.coordinator = address();
+            } else if (arg == "--data") {
+                args.data_dir = value();
+            } else if (arg == "--workers") {
+                args.workers = std::stoi(std::string(value()));
+            } else if (arg == "--spawn") {
+                args.spawn = true;
+            } else if (arg == "--layers") {
+                args.layer_sizes = split_list<int>(value(), [](const std::string& s) {
+                    return std::stoi(s);
+                });
+            } else if (arg == "--activations") {
+                args.activations = split_list<std::string>(value(), [](std::string s) {
+                    return s;
+                });
+            } else if (arg == "--loss") {
+                args.loss = value();
+            } else if (arg == "--epochs") {
+                args.epochs = std::stoi(std::string(value()));
+            } else if (arg == "--batch-size") {
+                args.batch_size = std::stoi(std::string(value()));
+            } else if (arg == "--micro-batch-size") {
+                args.micro_batch_size = std::stoi(std::string(value()));
+            } else if (arg == "--learning-rate") {
+                args.learning_rate = std::stod(std::string(value()));
+            } else if (arg == "--seed") {
+                args.seed = std::stoul(std::string(value()));
+            } else if (arg == "--output") {
+                args.output = std::string(value());
+            } else {
+                print_usage_and_exit();
+            }
+        }
+    } catch (const std::exception&) {
+        print_usage_and_exit();
+    }
+
+    if (!has_listen || (args.mode == Mode::Worker && !args.coordinator)) {
+        print_usage_and_exit();
+    }
+    if (args.workers < 1 || args.epochs < 1 || args.batch_size < args.workers) {
+        print_usage_and_exit();
+    }
+    // One activation per layer after the input
+    if (args.layer_sizes.size() < 2 || args.activations.size() + 1 != args.layer_sizes.size()) {
+        std::println("Expected at least two layers and one activation per non-input layer");
+        print_usage_and_exit();
+    }
+
+    return args;
+}
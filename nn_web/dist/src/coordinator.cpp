@@ -0,0 +1,175 @@
+#include "coordinator.hpp"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <nn_lib/network.hpp>
+#include <ranges>
+#include "dataset.hpp"
+#include "memmat.hpp"
+#include "protocol.hpp"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+Address worker_address(const Address& coordinator, int index) {
+    Address address = coordinator;
+    if (address.kind == Address::Kind::Unix) {
+        address.path += "." + std::to_string(index);
+    } else {
+        address.port += 1 + index;
+    }
+    return address;
+}
+
+std::vector<pid_t> spawn_workers(const CliArgs& args) {
+    std::vector<pid_t> pids;
+    for (int i = 0; i < args.workers; i++) {
+        std::vector<std::string> worker_args = {
+            "nn_dist",
+            "worker",
+            "--coordinator",
+            args.listen.str(),
+            "--listen",
+            worker_address(args.listen, i).str(),
+            "--data",
+            args.data_dir,
+        };
+
+        pid_t pid = fork();
+        if (pid == -1) {
+            throw std::runtime_error("fork failed");
+        }
+        if (pid == 0) {
+            std::vector<char*> argv;
+            for (auto& arg : worker_args) {
+                argv.push_back(arg.data());
+            }
+            argv.push_back(nullptr);
+            execv("/proc/self/exe", argv.data());
+            std::_Exit(127);
+        }
+        pids.push_back(pid);
+    }
+    return pids;
+}
+
+void write_doubles(const std::string& path, const std::vector<double>& values) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+    if (!out) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
+
+}
+
+int run_coordinator(const CliArgs& args) {
+    auto hidden_activations_view =
+        args.activations | std::views::take(args.activations.size() - 1);
+    auto hidden_activations = nn::strs_to_hidden_activation(hidden_activations_view);
+    auto output_activation = nn::str_to_output_activation(args.activations.back());
+    auto loss = nn::str_to_loss(args.loss);
+    if (!hidden_activations || !output_activation || !loss) {
+        spdlog::error("Invalid activation or loss function");
+        return 1;
+    }
+
+    std::srand(args.seed);
+    auto network_opt = nn::Network::new_random(
+        args.layer_sizes, *hidden_activations, *output_activation, *loss
+    );
+    if (!network_opt) {
+        spdlog::error("Invalid network configuration");
+        return 1;
+    }
+    auto network = network_opt.value();
+
+    auto listener = listen_on(args.listen);
+    spdlog::info("Coordinator listening on {}", args.listen.str());
+
+    std::vector<pid_t> children;
+    if (args.spawn) {
+        children = spawn_workers(args);
+    }
+
+    std::vector<Socket> workers;
+    std::vector<std::string> worker_addresses;
+    for (int i = 0; i < args.workers; i++) {
+        workers.push_back(accept_from(listener));
+        worker_addresses.push_back(workers.back().recv_string());
+        spdlog::info("Worker {} registered from {}", i, worker_addresses.back());
+    }
+
+    // Equal shards keep the number of batches per epoch identical on every rank, the remainder
+    // of the training set is left out
+    int shard_size = TRAIN_SIZE / args.workers;
+    int worker_batch_size = args.batch_size / args.workers;
+
+    auto weights = network.dump_weights();
+    auto biases = network.dump_biases();
+    for (int rank = 0; rank < args.workers; rank++) {
+        TrainSetup setup{
+            .rank = rank,
+            .world_size = args.workers,
+            .shard_begin = rank * shard_size,
+            .shard_size = shard_size,
+            .epochs = args.epochs,
+            .batch_size = worker_batch_size,
+            .learning_rate = args.learning_rate,
+            .micro_batch_size = args.micro_batch_size,
+            .layer_sizes = args.layer_sizes,
+            .activations = args.activations,
+            .loss = args.loss,
+            .weights = weights,
+            .biases = biases,
+            .next_address = worker_addresses[(rank + 1) % args.workers],
+        };
+        setup.write(workers[rank]);
+    }
+    spdlog::info(
+        "Training on {} workers, {} samples and batch size {} per worker", args.workers,
+        shard_size, worker_batch_size
+    );
+
+    std::optional<TrainResult> trained;
+    for (int rank = 0; rank < args.workers; rank++) {
+        auto result = TrainResult::read(workers[rank]);
+        if (rank == 0) {
+            trained = std::move(result);
+        }
+    }
+
+    for (size_t epoch = 0; epoch < trained->losses.size(); epoch++) {
+        spdlog::info("Epoch {} loss {:.5f}", epoch + 1, trained->losses[epoch]);
+    }
+
+    auto trained_network = nn::Network::from_data(
+        args.layer_sizes, trained->weights, trained->biases, *hidden_activations,
+        *output_activation, *loss
+    );
+    if (!trained_network) {
+        spdlog::error("Rank 0 returned malformed weights");
+        return 1;
+    }
+
+    MemMatrix test_inputs(args.test_inputs(), IMAGE_SIZE, TEST_SIZE);
+    MemMatrix test_labels(args.test_labels(), LABEL_SIZE, TEST_SIZE);
+    std::vector<int> labels(TEST_SIZE);
+    for (int i = 0; i < TEST_SIZE; i++) {
+        test_labels.mat().col(i).maxCoeff(&labels[i]);
+    }
+    int correct = trained_network->evaluate_onehot(test_inputs.mat(), labels);
+    spdlog::info("Test accuracy: {}/{}", correct, TEST_SIZE);
+
+    if (args.output) {
+        write_doubles(*args.output + ".weights.bin", trained->weights);
+        write_doubles(*args.output + ".biases.bin", trained->biases);
+        spdlog::info("Saved trained network to {}.{{weights,biases}}.bin", *args.output);
+    }
+
+    for (pid_t pid : children) {
+        waitpid(pid, nullptr, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include <Eigen/Core>
+#include "cli.hpp"
+#include "coordinator.hpp"
+#include "spdlog/spdlog.h"
+#include "worker.hpp"
+
+int main(int argc, char** argv) {
+    CliArgs args = CliArgs::parse(argc, argv);
+    // Replicas run as separate processes, several of them may share a machine
+    Eigen::setNbThreads(1);
+
+    try {
+        if (args.mode == Mode::Coordinator) {
+            return run_coordinator(args);
+        }
+        return run_worker(args);
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+}
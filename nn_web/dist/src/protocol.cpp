@@ -0,0 +1,66 @@
+#include "protocol.hpp"
+
+void TrainSetup::write(Socket& sock) const {
+    sock.send_value(rank);
+    sock.send_value(world_size);
+    sock.send_value(shard_begin);
+    sock.send_value(shard_size);
+
+    sock.send_value(epochs);
+    sock.send_value(batch_size);
+    sock.send_value(learning_rate);
+    sock.send_value(micro_batch_size.value_or(0));
+
+    sock.send_vector(layer_sizes);
+    sock.send_value<uint64_t>(activations.size());
+    for (const auto& activation : activations) {
+        sock.send_string(activation);
+    }
+    sock.send_string(loss);
+    sock.send_vector(weights);
+    sock.send_vector(biases);
+
+    sock.send_string(next_address);
+}
+
+TrainSetup TrainSetup::read(Socket& sock) {
+    TrainSetup setup;
+    setup.rank = sock.recv_value<int>();
+    setup.world_size = sock.recv_value<int>();
+    setup.shard_begin = sock.recv_value<int>();
+    setup.shard_size = sock.recv_value<int>();
+
+    setup.epochs = sock.recv_value<int>();
+    setup.batch_size = sock.recv_value<int>();
+    setup.learning_rate = sock.recv_value<double>();
+    int micro_batch_size = sock.recv_value<int>();
+    if (micro_batch_size > 0) {
+        setup.micro_batch_size = micro_batch_size;
+    }
+
+    setup.layer_sizes = sock.recv_vector<int>();
+    auto activation_count = sock.recv_value<uint64_t>();
+    for (uint64_t i = 0; i < activation_count; i++) {
+        setup.activations.push_back(sock.recv_string());
+    }
+    setup.loss = sock.recv_string();
+    setup.weights = sock.recv_vector<double>();
+    setup.biases = sock.recv_vector<double>();
+
+    setup.next_address = sock.recv_string();
+    return setup;
+}
+
+void TrainResult::write(Socket& sock) const {
+    sock.send_vector(losses);
+    sock.send_vector(weights);
+    sock.send_vector(biases);
+}
+
+TrainResult TrainResult::read(Socket& sock) {
+    TrainResult result;
+    result.losses = sock.recv_vector<double>();
+    result.weights = sock.recv_vector<double>();
+    result.biases = sock.recv_vector<double>();
+    return result;
+}
@@ -0,0 +1,40 @@
+#include "ring.hpp"
+#include <algorithm>
+#include <functional>
+
+RingAllReduce::RingAllReduce(int rank, int world_size, Socket next, Socket prev)
+: m_rank(rank), m_world_size(world_size), m_next(std::move(next)), m_prev(std::move(prev)) {
+}
+
+std::span<double> RingAllReduce::chunk(std::span<double> buffer, int index) const {
+    index = ((index % m_world_size) + m_world_size) % m_world_size;
+    size_t begin = buffer.size() * index / m_world_size;
+    size_t end = buffer.size() * (index + 1) / m_world_size;
+    return buffer.subspan(begin, end - begin);
+}
+
+void RingAllReduce::operator()(std::span<double> buffer) {
+    if (m_world_size == 1) {
+        return;
+    }
+
+    m_scratch.resize(buffer.size() / m_world_size + 1);
+
+    // Reduce-scatter: afterwards this rank holds the full sum of chunk rank + 1
+    for (int step = 0; step < m_world_size - 1; step++) {
+        auto send = chunk(buffer, m_rank - step);
+        auto recv = chunk(buffer, m_rank - step - 1);
+        auto scratch = std::span(m_scratch).first(recv.size());
+
+        exchange(m_next, std::as_bytes(send), m_prev, std::as_writable_bytes(scratch));
+        std::ranges::transform(recv, scratch, recv.begin(), std::plus{});
+    }
+
+    // All-gather: pass the finished chunks around the ring
+    for (int step = 0; step < m_world_size - 1; step++) {
+        auto send = chunk(buffer, m_rank + 1 - step);
+        auto recv = chunk(buffer, m_rank - step);
+
+        exchange(m_next, std::as_bytes(send), m_prev, std::as_writable_bytes(recv));
+    }
+}
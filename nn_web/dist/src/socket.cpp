@@ -0,0 +1,308 @@
+#include "socket.hpp"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+[[noreturn]] void throw_errno(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+sockaddr_un unix_sockaddr(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Unix socket path too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+addrinfo* resolve(const Address& address, bool passive) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+    addrinfo* res;
+    auto port = std::to_string(address.port);
+    int rc = getaddrinfo(address.host.c_str(), port.c_str(), &hints, &res);
+    if (rc != 0) {
+        throw std::runtime_error("Failed to resolve " + address.str() + ": " + gai_strerror(rc));
+    }
+    return res;
+}
+
+void set_nodelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+}
+
+std::expected<Address, std::string> Address::parse(std::string_view s) {
+    Address address;
+    if (s.starts_with("unix:")) {
+        address.kind = Kind::Unix;
+        address.path = s.substr(5);
+        if (address.path.empty()) {
+            return std::unexpected("Empty unix socket path");
+        }
+        return address;
+    }
+
+    if (s.starts_with("tcp:")) {
+        auto rest = s.substr(4);
+        auto colon = rest.rfind(':');
+        if (colon == std::string_view::npos) {
+            return std::unexpected("Missing port in address: " + std::string(s));
+        }
+
+        address.kind = Kind::Tcp;
+        address.host = rest.substr(0, colon);
+        auto port_str = rest.substr(colon + 1);
+        auto [ptr, ec] =
+            std::from_chars(port_str.data(), port_str.data() + port_str.size(), address.port);
+        if (ec != std::errc{} || ptr != port_str.data() + port_str.size()) {
+            return std::unexpected("Invalid port in address: " + std::string(s));
+        }
+        return address;
+    }
+
+    return std::unexpected("Address must start with unix: or tcp: " + std::string(s));
+}
+
+std::string Address::str() const {
+    if (kind == Kind::Unix) {
+        return "unix:" + path;
+    }
+    return "tcp:" + host + ":" + std::to_string(port);
+}
+
+Socket::Socket(int fd) : m_fd(fd) {
+}
+
+Socket::~Socket() {
+    if (m_fd != -1) {
+        close(m_fd);
+    }
+}
+
+Socket::Socket(Socket&& other) noexcept : m_fd(std::exchange(other.m_fd, -1)) {
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept {
+    if (this != &other) {
+        if (m_fd != -1) {
+            close(m_fd);
+        }
+        m_fd = std::exchange(other.m_fd, -1);
+    }
+    return *this;
+}
+
+void Socket::send_all(const void* data, size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::send(m_fd, bytes, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("send failed");
+        }
+        bytes += n;
+        size -= n;
+    }
+}
+
+void Socket::recv_all(void* data, size_t size) {
+    auto bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = ::recv(m_fd, bytes, size, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("recv failed");
+        }
+        if (n == 0) {
+            throw std::runtime_error("Peer closed the connection");
+        }
+        bytes += n;
+        size -= n;
+    }
+}
+
+void Socket::send_string(std::string_view s) {
+    send_value<uint64_t>(s.size());
+    send_all(s.data(), s.size());
+}
+
+std::string Socket::recv_string() {
+    std::string s(recv_value<uint64_t>(), '\0');
+    recv_all(s.data(), s.size());
+    return s;
+}
+
+Socket listen_on(const Address& address) {
+    if (address.kind == Address::Kind::Unix) {
+        Socket sock(socket(AF_UNIX, SOCK_STREAM, 0));
+        if (sock.fd() == -1) {
+            throw_errno("socket failed");
+        }
+
+        auto addr = unix_sockaddr(address.path);
+        unlink(address.path.c_str());
+        if (bind(sock.fd(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+            throw_errno("Failed to bind " + address.str());
+        }
+        if (listen(sock.fd(), SOMAXCONN) == -1) {
+            throw_errno("Failed to listen on " + address.str());
+        }
+        return sock;
+    }
+
+    addrinfo* res = resolve(address, true);
+    Socket sock(socket(res->ai_family, res->ai_socktype, res->ai_protocol));
+    if (sock.fd() == -1) {
+        freeaddrinfo(res);
+        throw_errno("socket failed");
+    }
+
+    int one = 1;
+    setsockopt(sock.fd(), SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    int rc = bind(sock.fd(), res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc == -1) {
+        throw_errno("Failed to bind " + address.str());
+    }
+    if (listen(sock.fd(), SOMAXCONN) == -1) {
+        throw_errno("Failed to listen on " + address.str());
+    }
+    return sock;
+}
+
+Socket connect_to(const Address& address) {
+    const int attempts = 50;
+    const auto retry_delay = std::chrono::milliseconds(100);
+
+    for (int attempt = 1;; attempt++) {
+        int rc;
+        Socket sock;
+
+        if (address.kind == Address::Kind::Unix) {
+            sock = Socket(socket(AF_UNIX, SOCK_STREAM, 0));
+            if (sock.fd() == -1) {
+                throw_errno("socket failed");
+            }
+            auto addr = unix_sockaddr(address.path);
+            rc = connect(sock.fd(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        } else {
+            addrinfo* res = resolve(address, false);
+            sock = Socket(socket(res->ai_family, res->ai_socktype, res->ai_protocol));
+            if (sock.fd() == -1) {
+                freeaddrinfo(res);
+                throw_errno("socket failed");
+            }
+            rc = connect(sock.fd(), res->ai_addr, res->ai_addrlen);
+            freeaddrinfo(res);
+            if (rc == 0) {
+                set_nodelay(sock.fd());
+            }
+        }
+
+        if (rc == 0) {
+            return sock;
+        }
+        if (attempt == attempts) {
+            throw_errno("Failed to connect to " + address.str());
+        }
+        std::this_thread::sleep_for(retry_delay);
+    }
+}
+
+Socket accept_from(const Socket& listener) {
+    while (true) {
+        int fd = accept(listener.fd(), nullptr, nullptr);
+        if (fd == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("accept failed");
+        }
+
+        sockaddr_storage addr;
+        socklen_t len = sizeof(addr);
+        if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0
+            && addr.ss_family != AF_UNIX) {
+            set_nodelay(fd);
+        }
+        return Socket(fd);
+    }
+}
+
+void exchange(
+    Socket& send_to, std::span<const std::byte> send, Socket& recv_from, std::span<std::byte> recv
+) {
+    size_t sent = 0;
+    size_t received = 0;
+
+    while (sent < send.size() || received < recv.size()) {
+        pollfd fds[2];
+        int nfds = 0;
+        int send_idx = -1;
+        int recv_idx = -1;
+
+        if (sent < send.size()) {
+            send_idx = nfds;
+            fds[nfds++] = pollfd{ send_to.fd(), POLLOUT, 0 };
+        }
+        if (received < recv.size()) {
+            recv_idx = nfds;
+            fds[nfds++] = pollfd{ recv_from.fd(), POLLIN, 0 };
+        }
+
+        if (poll(fds, nfds, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("poll failed");
+        }
+
+        if (send_idx != -1 && fds[send_idx].revents) {
+            ssize_t n = ::send(
+                send_to.fd(), send.data() + sent, send.size() - sent, MSG_DONTWAIT | MSG_NOSIGNAL
+            );
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                throw_errno("send failed");
+            }
+            sent += std::max<ssize_t>(n, 0);
+        }
+        if (recv_idx != -1 && fds[recv_idx].revents) {
+            ssize_t n = ::recv(
+                recv_from.fd(), recv.data() + received, recv.size() - received, MSG_DONTWAIT
+            );
+            if (n == 0) {
+                throw std::runtime_error("Peer closed the connection");
+            }
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                throw_errno("recv failed");
+            }
+            received += std::max<ssize_t>(n, 0);
+        }
+    }
+}
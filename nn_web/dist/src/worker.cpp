@@ -0,0 +1,75 @@
+#include "worker.hpp"
+#include <nn_lib/network.hpp>
+#include <ranges>
+#include "dataset.hpp"
+#include "memmat.hpp"
+#include "protocol.hpp"
+#include "ring.hpp"
+#include "spdlog/spdlog.h"
+
+int run_worker(const CliArgs& args) {
+    // Listen before registering so the previous rank can connect as soon as ranks are assigned
+    auto listener = listen_on(args.listen);
+    auto coordinator = connect_to(*args.coordinator);
+    coordinator.send_string(args.listen.str());
+
+    auto setup = TrainSetup::read(coordinator);
+    spdlog::info(
+        "Rank {}/{} owns samples [{}, {})", setup.rank, setup.world_size, setup.shard_begin,
+        setup.shard_begin + setup.shard_size
+    );
+
+    std::optional<RingAllReduce> ring;
+    if (setup.world_size > 1) {
+        auto next_address = Address::parse(setup.next_address).value();
+        Socket next = connect_to(next_address);
+        Socket prev = accept_from(listener);
+        ring.emplace(setup.rank, setup.world_size, std::move(next), std::move(prev));
+    }
+
+    MemMatrix inputs(
+        args.train_inputs(), IMAGE_SIZE, TRAIN_SIZE, setup.shard_begin, setup.shard_size
+    );
+    MemMatrix labels(
+        args.train_labels(), LABEL_SIZE, TRAIN_SIZE, setup.shard_begin, setup.shard_size
+    );
+
+    auto hidden_activations_view =
+        setup.activations | std::views::take(setup.activations.size() - 1);
+    auto hidden_activations = nn::strs_to_hidden_activation(hidden_activations_view).value();
+    auto output_activation = nn::str_to_output_activation(setup.activations.back()).value();
+    auto loss = nn::str_to_loss(setup.loss).value();
+
+    auto network_opt = nn::Network::from_data(
+        setup.layer_sizes, setup.weights, setup.biases, hidden_activations, output_activation, loss
+    );
+    if (!network_opt) {
+        spdlog::error("Received malformed weights from the coordinator");
+        return 1;
+    }
+    auto network = network_opt.value();
+
+    // One loss entry per epoch
+    int batches_per_epoch = (setup.shard_size + setup.batch_size - 1) / setup.batch_size;
+    nn::SGDHyperparams hyperparams{ setup.learning_rate, setup.epochs, setup.batch_size,
+                                    batches_per_epoch, setup.micro_batch_size };
+
+    nn::GradientReducer reducer;
+    if (ring) {
+        reducer = [&ring](std::span<double> buffer) {
+            (*ring)(buffer);
+        };
+    }
+    auto losses = network.train_sgd(inputs.mat(), labels.mat(), hyperparams, reducer);
+
+    TrainResult result;
+    result.losses = losses.value_or(std::vector<double>{});
+    if (setup.rank == 0) {
+        result.weights = network.dump_weights();
+        result.biases = network.dump_biases();
+    }
+    result.write(coordinator);
+
+    spdlog::info("Rank {} finished", setup.rank);
+    return 0;
+}
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <expected>
 #include <httc/router.hpp>
 #include <httc/status.hpp>
 #include <nlohmann/json.hpp>
+#include "checkpoints.hpp"
+#include "config.hpp"
 #include "httc/response.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "model_cache.hpp"
 #include "state.hpp"
+#include "sweep.hpp"
+#include "training.hpp"
+#include "websocket.hpp"
 
 struct FieldError {
     std::string field;
@@ -13,8 +22,16 @@ struct FieldError {
 void to_json(json& j, const FieldError& v);
 
 struct ApiResponse {
+    struct RawBody {
+        std::string content_type;
+        std::string data;
+    };
+
     httc::StatusCode status;
     std::optional<json> resp;
+    // Sent as is instead of resp when set
+    std::optional<RawBody> raw = std::nullopt;
+    std::vector<std::pair<std::string, std::string>> headers = {};
 
     // Static helper to initialize streaming on a response
     static asio::awaitable<httc::Response::ChunkedStream> stream(
@@ -35,6 +52,19 @@ struct ApiResponse {
         return ApiResponse{ httc::StatusCode::OK, resp };
     }
 
+    static ApiResponse accepted(json resp) {
+        return ApiResponse{ httc::StatusCode::ACCEPTED, resp };
+    }
+
+    static ApiResponse ok_raw(std::string content_type, std::string data) {
+        return ApiResponse{ httc::StatusCode::OK, std::nullopt,
+                            RawBody{ std::move(content_type), std::move(data) } };
+    }
+
+    static ApiResponse not_modified() {
+        return ApiResponse{ httc::StatusCode::NOT_MODIFIED, std::nullopt };
+    }
+
     static ApiResponse error(httc::StatusCode status, std::string_view message) {
         return ApiResponse{ status, json{ { "error", message } } };
     }
@@ -55,12 +85,30 @@ struct ApiResponse {
         return ApiResponse{ httc::StatusCode::BAD_REQUEST, err };
     }
 
-    void to_response(httc::Response& res);
+    // Returns the size of the body set on the response
+    size_t to_response(httc::Response& res);
 };
 
+// Threading model
+//
+// The io_context runs on IO_THREADS threads, so handlers and the coroutines they await resume
+// on any of them and must not share unsynchronized state:
+// - Db serializes every sqlite call on its own single thread pool
+// - ModelCache and PredictBatcher lock internally, cached models are immutable and shared
+// - Metrics only updates atomics once the routes are registered, the tracer writes spans to
+//   its ring buffer without locks
+// - training jobs publish immutable snapshots through LiveModels, read without locks
+// - EvaluationCache locks internally, evaluations are immutable and shared
+// - the MemMatrix datasets are read only after startup
+// - inference runs on State::inference_pool and training, on a private copy of the network, on
+//   State::training_pool. I/O threads only parse, route and serialize
+// - training jobs are admitted and ordered by TrainingScheduler, which locks internally
+// - CheckpointWriter queues checkpoints under a lock and writes them from one coroutine
+// - sweeps lock their own state, their runners follow the training jobs through the scheduler
+// - each WebSocket session and its idle watchdog share a strand
 class App {
 public:
-    App(std::optional<std::string_view> static_assets_path);
+    App(Config config);
 
     void run();
 
@@ -72,13 +120,82 @@ private:
 
     asio::awaitable<ApiResponse> predict(const httc::Request& req);
     asio::awaitable<ApiResponse> predict_custom(const httc::Request& req);
-    asio::awaitable<ApiResponse> train_network(const httc::Request& req, httc::Response& res);
+    asio::awaitable<ApiResponse> predict_range(const httc::Request& req, httc::Response& res);
+    asio::awaitable<ApiResponse> predict_batch(const httc::Request& req, httc::Response& res);
+    // Feeds the same inputs through several networks at once, optionally averaging their outputs
+    asio::awaitable<ApiResponse> compare_networks(const httc::Request& req);
+    asio::awaitable<ApiResponse> train_network(const httc::Request& req);
+
+    asio::awaitable<ApiResponse> get_jobs(const httc::Request& req);
+    asio::awaitable<ApiResponse> get_job(const httc::Request& req);
+    asio::awaitable<ApiResponse> cancel_job(const httc::Request& req);
+
+    // Trains every config of a sweep and drops the weaker half (by default) after each rung
+    asio::awaitable<ApiResponse> create_sweep(const httc::Request& req);
+    asio::awaitable<ApiResponse> get_sweeps(const httc::Request& req);
+    asio::awaitable<ApiResponse> get_sweep(const httc::Request& req);
+    asio::awaitable<ApiResponse> cancel_sweep(const httc::Request& req);
 
     asio::awaitable<ApiResponse> get_data(const httc::Request& req);
+    asio::awaitable<ApiResponse> get_data_png(const httc::Request& req);
+    asio::awaitable<ApiResponse> get_data_range(const httc::Request& req);
+    asio::awaitable<ApiResponse> get_stats(const httc::Request& req);
+    asio::awaitable<ApiResponse> get_metrics(const httc::Request& req);
+    // 503 until the warm-up finished, so load balancers only route to warm instances
+    asio::awaitable<ApiResponse> get_ready(const httc::Request& req);
+    // The spans in the trace buffer as Chrome trace event JSON
+    asio::awaitable<ApiResponse> get_trace(const httc::Request& req);
+
+    // Returns the latest live snapshot of the network if it is being trained and prefer_live is
+    // set, otherwise the network from the model cache, loading it from the database on a miss
+    asio::awaitable<std::expected<std::shared_ptr<const Model>, ApiResponse>>
+        load_model(int network_id, bool prefer_live = true);
+    asio::awaitable<std::expected<void, std::string>> run_training_job(
+        std::shared_ptr<TrainJob> job
+    );
+    // Successive halving over the sweep's trials: every rung trains the remaining trials up to
+    // the rung's epoch count, evaluates them on the test set and keeps the best ones
+    asio::awaitable<void> run_sweep(std::shared_ptr<Sweep> sweep);
+    // Submits a training job per trial, at most the sweep's parallelism at a time, and returns
+    // once they all finished. Cancelling the sweep cancels its jobs and returns right away
+    asio::awaitable<void> train_sweep_rung(
+        Sweep& sweep, const std::vector<size_t>& trials, int target_epochs
+    );
+    // Accepts WebSocket connections on WS_PORT, each runs a prediction session on its own strand
+    asio::awaitable<void> listen_websockets();
+    // Streams predictions for one network: binary input frames in, binary output frames out
+    asio::awaitable<void> predict_session(asio::ip::tcp::socket socket);
+
+    // Prefaults the dataset mappings, then loads the newest WARMUP_MODELS networks into the model
+    // cache and runs one prediction on each. Sets m_ready when done
+    asio::awaitable<void> warm_up();
+    // Resubmits the jobs that were still training when the server stopped
+    asio::awaitable<void> resume_training();
+
+    // Evaluates the model on the test set in the background, filling the evaluation cache and
+    // the network's correct_predictions and cost. Does nothing for live snapshots and versions
+    // already evaluated or being evaluated
+    void schedule_evaluation(std::shared_ptr<const Model> model);
+    asio::awaitable<std::shared_ptr<const Evaluation>> evaluate(std::shared_ptr<const Model> model);
+    // The test set evaluation of the model, computed now unless it is cached
+    asio::awaitable<std::shared_ptr<const Evaluation>> evaluation_of(
+        std::shared_ptr<const Model> model
+    );
+    // Evaluates the stored networks that were never evaluated, which have a cost of 0
+    asio::awaitable<void> evaluate_unevaluated_networks();
 
 private:
-    std::optional<std::string_view> m_static_assets_path;
+    Config m_config;
+    asio::io_context m_io_ctx;
+    Metrics m_metrics;
+    AccessLog m_access_log;
+    // Groups the trace spans of a request
+    std::atomic<uint64_t> m_next_request_id = 1;
+    std::atomic<bool> m_ready = false;
 
     std::shared_ptr<httc::Router> m_router;
     std::shared_ptr<State> m_state;
+    std::unique_ptr<TrainingScheduler> m_training;
+    std::unique_ptr<CheckpointWriter> m_checkpoints;
+    SweepRegistry m_sweeps;
 };
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "asio/any_io_executor.hpp"
+#include "asio/awaitable.hpp"
+#include "model_cache.hpp"
+
+struct PredictBatcherStats {
+    uint64_t requests;
+    uint64_t batches;
+    size_t max_batch_size;
+    int64_t max_wait_us;
+};
+
+// Coalesces concurrent single sample predictions on the same model into one batched
+// feed_forward. A batch is flushed once it holds max_batch_size samples or max_wait after its
+// first sample arrived, whichever comes first. Safe to use from any number of threads
+class PredictBatcher {
+public:
+    // Batches are fed forward on compute_executor
+    PredictBatcher(
+        asio::any_io_executor compute_executor, size_t max_batch_size,
+        std::chrono::microseconds max_wait
+    );
+
+    // Output column of model->network for a single input column
+    asio::awaitable<Eigen::VectorXd> predict(
+        std::shared_ptr<const Model> model, Eigen::VectorXd input
+    );
+
+    PredictBatcherStats stats() const;
+
+private:
+    struct Pending {
+        Eigen::VectorXd input;
+        Eigen::VectorXd output;
+
+        std::mutex mutex;
+        bool done = false;
+        // Set when the coroutine suspended before its batch was flushed, posts its resumption
+        std::function<void()> resume;
+    };
+
+    struct Batch {
+        std::shared_ptr<const Model> model;
+        uint64_t serial;
+        std::vector<std::shared_ptr<Pending>> pending;
+    };
+
+    // Keyed by model address, a reloaded model never joins a batch of its stale version
+    using Batches = std::unordered_map<const Model*, Batch>;
+
+    // Suspends until pending is done, returns immediately if it already is
+    static asio::awaitable<void> wait(std::shared_ptr<Pending> pending);
+    static void complete(Pending& pending);
+
+    // Both expect m_mutex to be held
+    Batch take(Batches::iterator it);
+    void schedule_flush(asio::any_io_executor executor, const Model* key, uint64_t serial);
+
+    // Feeds the batch forward on the compute executor and completes its requests
+    void dispatch(Batch batch);
+    void run(Batch batch);
+
+    asio::any_io_executor m_compute_executor;
+    size_t m_max_batch_size;
+    std::chrono::microseconds m_max_wait;
+
+    std::mutex m_mutex;
+    Batches m_batches;
+    uint64_t m_next_serial = 0;
+
+    std::atomic<uint64_t> m_requests = 0;
+    std::atomic<uint64_t> m_batch_count = 0;
+};
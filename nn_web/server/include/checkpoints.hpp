@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include "asio/any_io_executor.hpp"
+#include "asio/awaitable.hpp"
+#include "db.hpp"
+
+struct CheckpointWriterStats {
+    uint64_t written;
+    uint64_t coalesced;
+};
+
+// Writes training checkpoints to the database in the background. Training hands a checkpoint
+// over without waiting on any I/O, and checkpoints of the same network that pile up while the
+// database is busy are coalesced so only the newest one is written
+class CheckpointWriter {
+public:
+    CheckpointWriter(Db& db, asio::any_io_executor executor);
+
+    void save(Checkpoint checkpoint);
+    // Deletes the network's checkpoint once everything queued before is written
+    void discard(int network_id);
+
+    CheckpointWriterStats stats() const;
+
+private:
+    // A checkpoint to write, or nullopt to delete the network's checkpoint
+    using Operation = std::optional<Checkpoint>;
+
+    void enqueue(int network_id, Operation operation);
+    asio::awaitable<void> flush();
+
+    Db& m_db;
+    asio::any_io_executor m_executor;
+
+    std::mutex m_mutex;
+    std::map<int, Operation> m_pending;
+    bool m_flushing = false;
+
+    std::atomic<uint64_t> m_written = 0;
+    std::atomic<uint64_t> m_coalesced = 0;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "asio/any_io_executor.hpp"
+#include "asio/awaitable.hpp"
+#include "asio/co_spawn.hpp"
+#include "asio/executor_work_guard.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "asio/redirect_error.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/strand.hpp"
+#include "asio/this_coro.hpp"
+#include "asio/use_awaitable.hpp"
+
+// Fixed set of threads for CPU bound work, kept apart from the I/O threads so long computations
+// never hold up other connections
+class ComputePool {
+public:
+    // When cpus is not empty, thread i is pinned to cpus[i % cpus.size()]
+    ComputePool(std::string name, int threads, const std::vector<int>& cpus = {});
+    ~ComputePool();
+
+    ComputePool(const ComputePool&) = delete;
+    ComputePool& operator=(const ComputePool&) = delete;
+
+    asio::any_io_executor executor();
+    int size() const;
+
+    // Runs f on the pool, the awaiting coroutine resumes on its own executor with the result
+    template<typename F>
+    asio::awaitable<std::invoke_result_t<F>> run(F f) {
+        using ReturnType = std::invoke_result_t<F>;
+        co_return co_await asio::co_spawn(executor(), [&]() -> asio::awaitable<ReturnType> {
+            co_return f();
+        }, asio::use_awaitable);
+    }
+
+    // Runs f(0) to f(count - 1) on the pool at the same time and returns their results in order
+    // once every call finished. f must not throw
+    template<typename F>
+    asio::awaitable<std::vector<std::invoke_result_t<F, int>>> run_all(int count, F f) {
+        std::vector<std::invoke_result_t<F, int>> results(count);
+        if (count == 0) {
+            co_return results;
+        }
+
+        // The counter and the timer are only touched on the strand, and the waiting coroutine
+        // holds it until it is suspended on the timer, so no completion can be missed
+        auto strand = asio::make_strand(co_await asio::this_coro::executor);
+        co_await asio::co_spawn(strand, [&]() -> asio::awaitable<void> {
+            asio::steady_timer done(strand, asio::steady_timer::time_point::max());
+            int remaining = count;
+            for (int i = 0; i < count; i++) {
+                asio::post(executor(), [&, i]() {
+                    results[i] = f(i);
+                    asio::post(strand, [&]() {
+                        if (--remaining == 0) {
+                            done.cancel();
+                        }
+                    });
+                });
+            }
+            asio::error_code ec;
+            co_await done.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }, asio::use_awaitable);
+
+        co_return results;
+    }
+
+private:
+    std::string m_name;
+    asio::io_context m_ctx;
+    asio::executor_work_guard<asio::io_context::executor_type> m_work;
+    std::vector<std::jthread> m_threads;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Server settings, read from environment variables
+struct Config {
+    static Config from_env();
+
+    // ASSETS_PATH
+    std::optional<std::string> static_assets_path;
+    // WS_PORT, port of the WebSocket prediction sessions, 0 turns them off
+    int ws_port;
+    // WS_IDLE_TIMEOUT_S, sessions without a message for this long are closed
+    std::chrono::seconds ws_idle_timeout;
+    // IO_THREADS, threads running the io_context, defaults to the number of cores
+    int io_threads;
+    // INFERENCE_THREADS and TRAINING_THREADS, sizes of the compute pools
+    int inference_threads;
+    int training_threads;
+    // With COMPUTE_AFFINITY=1 the inference and training pools are pinned to disjoint sets of
+    // cores, empty otherwise
+    std::vector<int> inference_cpus;
+    std::vector<int> training_cpus;
+    // TRAINING_JOBS_MAX, training jobs sharing the training pool at once, defaults to four per
+    // training thread
+    int training_jobs_max;
+    // TRAINING_QUEUE_MAX, jobs waiting to run before new submissions are rejected
+    size_t training_queue_max;
+    // TRAINING_SLICE_BATCHES, batches a job runs before the next job gets the worker
+    int training_slice_batches;
+    // LIVE_SNAPSHOT_BATCHES, batches between snapshots that predictions use during training
+    int live_snapshot_batches;
+    // CHECKPOINT_BATCHES, batches between checkpoints that let a job resume after a restart
+    int checkpoint_batches;
+    // TRACE_BUFFER_SIZE, spans kept for /api/admin/trace, 0 turns tracing off
+    size_t trace_buffer_size;
+    // LOG_QUEUE_SIZE, log records waiting for the logging thread, the oldest are dropped beyond it
+    size_t log_queue_size;
+    // ACCESS_LOG_SAMPLE, comma separated handler:n pairs, logging one in n requests to the handler.
+    // Failed requests are always logged
+    std::unordered_map<std::string, int> access_log_sample;
+    // MODEL_CACHE_SIZE, number of ready-to-run networks kept in memory
+    size_t model_cache_size;
+    // PREDICT_BATCH_MAX, most single sample predictions coalesced into one feed forward
+    size_t predict_batch_max;
+    // PREDICT_BATCH_WAIT_US, longest a prediction waits for others to join its batch
+    std::chrono::microseconds predict_batch_wait;
+    // WARMUP=0 skips the startup warm-up, the server then reports ready right away
+    bool warmup;
+    // WARMUP_MODELS, newest networks loaded and run once during warm-up, defaults to
+    // MODEL_CACHE_SIZE
+    size_t warmup_models;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <sqlite3.h>
+#include <atomic>
 #include <expected>
 #include <optional>
 #include <string>
@@ -40,6 +41,7 @@ struct NetworkFull {
     std::vector<double> biases;
     std::vector<std::string> activations;
     std::string loss;
+    int weights_version;
 };
 
 struct NetworkInfo {
@@ -54,6 +56,19 @@ struct NetworkInfo {
     std::string loss;
 };
 
+// Latest saved state of a training job, to resume it after a restart
+struct Checkpoint {
+    int network_id;
+    // JSON of the job parameters
+    std::string job_params;
+    std::vector<double> weights;
+    std::vector<double> biases;
+    int epoch;
+    int batch_offset;
+    int64_t samples_seen;
+    std::string rng_state;
+};
+
 void to_json(json& j, const NetworkFull& v);
 void to_json(json& j, const NetworkInfo& v);
 
@@ -63,7 +78,8 @@ public:
 
     ~Db();
 
-    asio::awaitable<DBResult<void>> add_network(const AddNetwork&& network);
+    // Returns the id of the new network
+    asio::awaitable<DBResult<int>> add_network(const AddNetwork&& network);
     asio::awaitable<DBResult<std::optional<NetworkFull>>> get_full_network_by_id(const int id);
     asio::awaitable<DBResult<std::optional<NetworkInfo>>> get_network_by_id(const int id);
     asio::awaitable<DBResult<std::vector<NetworkInfo>>> get_networks();
@@ -73,6 +89,18 @@ public:
         int id, const std::vector<double>& weights, const std::vector<double>& biases,
         int epochs_added
     );
+    // Stores test set results, unless the weights changed since version (weights_version)
+    asio::awaitable<DBResult<void>> update_network_evaluation(
+        int id, int version, int correct_predictions, double cost
+    );
+
+    // One checkpoint per network, saving replaces the previous one
+    asio::awaitable<DBResult<void>> save_checkpoint(Checkpoint checkpoint);
+    asio::awaitable<DBResult<void>> delete_checkpoint(int network_id);
+    asio::awaitable<DBResult<std::vector<Checkpoint>>> get_checkpoints();
+
+    // Operations waiting for or running on the database thread
+    size_t queue_depth() const;
 
 private:
     void create_statements();
@@ -80,6 +108,7 @@ private:
 
     sqlite3* m_db;
     asio::thread_pool m_pool;
+    std::atomic<size_t> m_queue_depth = 0;
 
     std::unordered_map<const char*, sqlite3_stmt*> m_stmts;
 };
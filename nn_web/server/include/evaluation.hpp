@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include "model_cache.hpp"
+
+// Results of one network version on a whole dataset, one sample per column
+struct Evaluation {
+    // Runs the model over every sample in one batched feed forward
+    static Evaluation compute(
+        const Model& model, const Eigen::Ref<const Eigen::MatrixXd>& inputs,
+        const Eigen::Ref<const Eigen::MatrixXd>& labels
+    );
+
+    int network_id;
+    int version;
+    Eigen::MatrixXd outputs;
+    Eigen::VectorXd losses;
+    std::vector<int> predictions;
+    int correct;
+    // Mean of losses
+    double cost;
+};
+
+// Test set evaluations keyed by network id and version, safe to use from any thread. Only the
+// newest evaluated version of each network is kept
+class EvaluationCache {
+public:
+    // nullptr unless that exact version has been evaluated
+    std::shared_ptr<const Evaluation> get(int id, int version) const;
+
+    // Claims the evaluation of a version, false if it is already evaluated or in progress. The
+    // caller has to follow up with put or abandon
+    bool try_start(int id, int version);
+    // False when the claim was dropped by invalidate, the evaluation is then not kept
+    bool put(std::shared_ptr<const Evaluation> evaluation);
+    void abandon(int id, int version);
+
+    void invalidate(int id);
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<int, std::shared_ptr<const Evaluation>> m_evaluations;
+    std::set<std::pair<int, int>> m_in_progress;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "asio/awaitable.hpp"
+
+// Shares a fixed number of worker slots between jobs by weighted fair queueing. Every job
+// accumulates virtual time, the time it held a slot divided by its weight, and a freed slot goes
+// to the waiting job with the least of it. Jobs thus get worker time in proportion to their
+// weights, and a short job that just arrived runs right away instead of behind the long ones
+class FairShare {
+public:
+    struct Client {
+        double weight = 1.0;
+        // Guarded by the FairShare
+        double virtual_time = 0.0;
+        bool has_slot = false;
+    };
+
+    // Joins on construction and leaves on destruction, so a job that ends early, with an
+    // exception included, neither keeps its slot nor stays in line. The client must outlive it
+    class Membership {
+    public:
+        Membership(FairShare& share, Client& client);
+        ~Membership();
+
+        Membership(const Membership&) = delete;
+        Membership& operator=(const Membership&) = delete;
+
+    private:
+        FairShare& m_share;
+        Client& m_client;
+    };
+
+    explicit FairShare(size_t slots);
+
+    // Starts the client at the current virtual time, so it neither starves the clients that
+    // have been running for a while nor gets starved by them
+    void join(Client& client);
+
+    // Waits for a slot
+    asio::awaitable<void> acquire(Client& client);
+    // Charges the client for the slice it just ran on its slot and hands the slot over when a
+    // waiting client is now further behind, waiting for its next turn
+    asio::awaitable<void> yield(Client& client, std::chrono::duration<double> elapsed);
+    // Gives the slot back for good, or gives up the place in line while waiting for one. Does
+    // nothing when the client has neither
+    void leave(Client& client);
+
+private:
+    struct Waiter {
+        Client* client;
+        std::function<void()> resume;
+    };
+
+    // All expect m_mutex to be held
+    // Hands a slot to the client, moving the virtual clock up to the client's virtual time
+    void grant(Client& client);
+    std::vector<Waiter>::iterator next_waiter();
+
+    std::mutex m_mutex;
+    size_t m_free;
+    // Virtual time of the latest slice handed out
+    double m_virtual_time = 0.0;
+    std::vector<Waiter> m_waiters;
+};
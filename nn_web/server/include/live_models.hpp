@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "model_cache.hpp"
+
+// Snapshots of networks that are being trained, published every few batches so predictions can
+// follow training without going through the database. Readers never take a lock: both the table
+// of snapshot slots and each slot are swapped atomically
+class LiveModels {
+public:
+    // One per training job, the job stores new snapshots into it
+    struct Slot {
+        std::atomic<std::shared_ptr<const Model>> model;
+    };
+
+    LiveModels();
+
+    // Makes the slot the live source for network_id, replacing any other
+    void attach(int network_id, std::shared_ptr<Slot> slot);
+    // Removes the slot unless another one replaced it in the meantime
+    void detach(int network_id, const std::shared_ptr<Slot>& slot);
+    // Removes whatever slot the network has, for deleted networks. The job keeps storing
+    // snapshots into its slot, but nobody reads them anymore
+    void remove(int network_id);
+
+    // Latest snapshot of the network, nullptr when it is not being trained or has not published
+    // one yet
+    std::shared_ptr<const Model> get(int network_id) const;
+
+private:
+    using Slots = std::unordered_map<int, std::shared_ptr<Slot>>;
+
+    // Serializes attach and detach, which copy the table and swap it in
+    std::mutex m_write_mutex;
+    std::atomic<std::shared_ptr<const Slots>> m_slots;
+};
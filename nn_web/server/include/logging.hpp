@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <spdlog/logger.h>
+#include "config.hpp"
+
+// Makes the default logger asynchronous: records are formatted on the calling thread and written
+// by a background thread from a queue of log_queue_size records. When the queue is full the
+// oldest records are dropped rather than blocking I/O threads
+void init_logging(const Config& config);
+
+// One logfmt record per API request, on its own "access" logger sharing the async queue
+class AccessLog {
+public:
+    struct Route {
+        // Whether to log this request, one in sample_every successful requests and every failed
+        // one
+        bool sample(int status);
+
+        uint64_t sample_every;
+        std::atomic<uint64_t> requests = 0;
+    };
+
+    struct Record {
+        std::string_view path;
+        int status;
+        std::chrono::steady_clock::duration duration;
+        size_t bytes_in;
+        // Body size of non-streamed responses, 0 for streamed ones
+        size_t bytes_out;
+    };
+
+    explicit AccessLog(const Config& config);
+
+    // The returned route lives as long as this object, look it up once when registering a route
+    Route* for_handler(std::string_view name);
+
+    // Method is whatever the request carries, it is only formatted for sampled requests
+    template<typename Method>
+    void log(const char* handler, Route& route, const Method& method, const Record& record) {
+        if (!route.sample(record.status)) {
+            return;
+        }
+        auto duration_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(record.duration).count();
+        m_logger->info(
+            "method={} path={} handler={} status={} duration_us={} bytes_in={} bytes_out={} "
+            "sample={}",
+            method, record.path, handler, record.status, duration_us, record.bytes_in,
+            record.bytes_out, route.sample_every
+        );
+    }
+
+private:
+    std::shared_ptr<spdlog::logger> m_logger;
+    std::unordered_map<std::string, int> m_sample_rates;
+
+    std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<Route>, std::less<>> m_routes;
+};
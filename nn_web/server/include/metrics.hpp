@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Duration histogram with fixed buckets, updated from any thread without locking
+class LatencyHistogram {
+public:
+    // Upper bounds of the buckets in seconds, ascending
+    explicit LatencyHistogram(std::vector<double> bounds);
+
+    // Records count observations of the same duration
+    void observe(std::chrono::duration<double> duration, uint64_t count = 1);
+
+    // Appends the histogram in the Prometheus text format, labels are added to every sample
+    void write(std::string& out, std::string_view name, std::string_view labels = "") const;
+
+private:
+    std::vector<double> m_bounds;
+    // One per bound plus one for +Inf, not cumulative
+    std::vector<std::atomic<uint64_t>> m_buckets;
+    std::atomic<uint64_t> m_count = 0;
+    std::atomic<uint64_t> m_sum_ns = 0;
+};
+
+// Requests served by one route handler
+struct HandlerMetrics {
+    HandlerMetrics();
+
+    void observe(int status, std::chrono::duration<double> duration);
+
+    // Indexed by the status class, 1xx to 5xx
+    std::array<std::atomic<uint64_t>, 5> responses;
+    LatencyHistogram latency;
+};
+
+// Counters and histograms collected by the server, exposed on /metrics. Gauges that other
+// components already track are read from them when rendering instead of duplicated here
+class Metrics {
+public:
+    Metrics();
+
+    // The returned metrics live as long as this object, look them up once when registering a
+    // route rather than per request
+    HandlerMetrics* for_handler(std::string_view name);
+
+    void observe_training(
+        uint64_t samples, uint64_t batches, std::chrono::duration<double> elapsed
+    );
+
+    // Appends every metric owned by this object in the Prometheus text format
+    void write(std::string& out) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<HandlerMetrics>, std::less<>> m_handlers;
+
+    std::atomic<uint64_t> m_training_samples = 0;
+    std::atomic<uint64_t> m_training_batches = 0;
+    // Average time of a batch within each slice a job runs
+    LatencyHistogram m_training_batch_time;
+};
+
+void write_metric_header(
+    std::string& out, std::string_view name, std::string_view type, std::string_view help
+);
+void write_gauge(std::string& out, std::string_view name, std::string_view help, double value);
+void write_counter(std::string& out, std::string_view name, std::string_view help, double value);
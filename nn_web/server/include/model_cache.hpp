@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <nn_lib/network.hpp>
+#include <optional>
+#include <unordered_map>
+#include "db.hpp"
+
+// A network loaded from the database, ready to run
+struct Model {
+    // Rebuilds the network from its stored representation, nullopt if it is malformed
+    static std::optional<Model> from_db(const NetworkFull& info);
+
+    int id;
+    // weights_version at load time, it changes whenever the stored weights do
+    int version;
+    std::vector<int> layer_sizes;
+    nn::Network network;
+    // Snapshot published by a running training job, its weights are not in the database
+    bool live = false;
+};
+
+struct ModelCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t size;
+    size_t capacity;
+};
+
+// Bounded LRU cache of ready-to-run networks keyed by network id, safe to use from any thread
+class ModelCache {
+public:
+    explicit ModelCache(size_t capacity);
+
+    std::shared_ptr<const Model> get(int id);
+
+    // Read before loading a model and pass it to put, so a model loaded from the database
+    // before an invalidation is not cached after it
+    uint64_t generation() const;
+    void put(std::shared_ptr<const Model> model, uint64_t generation);
+    void invalidate(int id);
+
+    ModelCacheStats stats() const;
+
+private:
+    using Entries = std::list<std::shared_ptr<const Model>>;
+
+    size_t m_capacity;
+
+    mutable std::mutex m_mutex;
+    // Most recently used first
+    Entries m_lru;
+    std::unordered_map<int, Entries::iterator> m_index;
+    uint64_t m_generation = 0;
+
+    std::atomic<uint64_t> m_hits = 0;
+    std::atomic<uint64_t> m_misses = 0;
+};
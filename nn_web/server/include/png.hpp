@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Encodes 8-bit grayscale pixels, row by row, as a PNG. The image data is stored uncompressed in
+// the deflate stream, which costs a few bytes per row but no compression work
+std::string encode_grayscale_png(std::span<const uint8_t> pixels, uint32_t width, uint32_t height);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include "asio/associated_executor.hpp"
+#include "asio/post.hpp"
+
+// Type erases a void() completion handler into a copyable callable that posts it to the
+// handler's associated executor, for coroutines parked until another thread wakes them up
+template<typename Handler>
+std::function<void()> make_resumer(Handler handler) {
+    auto shared_handler = std::make_shared<Handler>(std::move(handler));
+    return [shared_handler]() {
+        auto executor = asio::get_associated_executor(*shared_handler);
+        asio::post(executor, [shared_handler]() {
+            std::move(*shared_handler)();
+        });
+    };
+}
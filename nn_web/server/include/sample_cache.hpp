@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "memmat.hpp"
+
+enum class SampleFormat {
+    // {"expected_output": 3, "input": [0, 255, ...]}
+    Json,
+    // The label byte followed by one byte per pixel
+    Binary,
+    // 28x28 grayscale image
+    Png,
+};
+
+// Encoded dataset samples, built the first time each is requested and kept for the life of the
+// server since the datasets never change. Safe to use from any thread, two threads encoding the
+// same sample at once both produce the same bytes
+class SampleCache {
+public:
+    // source names the dataset in ETags
+    SampleCache(const MemMatrix& inputs, const MemMatrix& labels, std::string_view source);
+
+    int count() const;
+
+    // index must be within count
+    std::shared_ptr<const std::string> get(int index, SampleFormat format);
+
+    // Strong validator for the sample, or for count samples from index on
+    std::string etag(int index, SampleFormat format, int count = 1) const;
+
+    // Encoded size of every format, for memory reporting
+    size_t cached_bytes() const;
+
+private:
+    std::string encode(int index, SampleFormat format) const;
+
+    const MemMatrix& m_inputs;
+    const MemMatrix& m_labels;
+    int m_count;
+    std::string m_source;
+
+    // One slot per sample and format, filled on first use
+    std::vector<std::array<std::atomic<std::shared_ptr<const std::string>>, 3>> m_slots;
+    std::atomic<size_t> m_cached_bytes = 0;
+};
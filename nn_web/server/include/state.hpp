@@ -1,35 +1,72 @@
 #pragma once
 
+#include "batcher.hpp"
+#include "compute_pool.hpp"
+#include "config.hpp"
+#include "fair_share.hpp"
+#include "live_models.hpp"
+#include "dataset.hpp"
 #include "db.hpp"
+#include "evaluation.hpp"
 #include "memmat.hpp"
+#include "model_cache.hpp"
 #include "nlohmann/json.hpp"
-
-const int TRAIN_SIZE = 60000;
-const int TEST_SIZE = 10000;
-const int IMAGE_SIZE = 28 * 28;
-const int LABEL_SIZE = 10;
+#include "sample_cache.hpp"
 
 struct Sample {
     Eigen::MatrixXd input;
     Eigen::MatrixXd label;
 };
 
+// Inputs and one-hot labels of a whole dataset, one sample per column
+struct DataSource {
+    Eigen::Map<const Eigen::MatrixXd> inputs;
+    Eigen::Map<const Eigen::MatrixXd> labels;
+};
+
 struct State {
-    State()
+    State(const Config& config)
     : db("nn_web.db"), train_inputs("mnist_data/train_inputs.bin", IMAGE_SIZE, TRAIN_SIZE),
       train_labels("mnist_data/train_labels.bin", LABEL_SIZE, TRAIN_SIZE),
       test_inputs("mnist_data/test_inputs.bin", IMAGE_SIZE, TEST_SIZE),
-      test_labels("mnist_data/test_labels.bin", LABEL_SIZE, TEST_SIZE) {
+      test_labels("mnist_data/test_labels.bin", LABEL_SIZE, TEST_SIZE),
+      train_samples(train_inputs, train_labels, "train"),
+      test_samples(test_inputs, test_labels, "test"),
+      inference_pool("inference", config.inference_threads, config.inference_cpus),
+      training_pool("training", config.training_threads, config.training_cpus),
+      training_share(config.training_threads),
+      model_cache(config.model_cache_size),
+      predict_batcher(
+          inference_pool.executor(), config.predict_batch_max, config.predict_batch_wait
+      ) {
     }
 
+    // source is "test" or "train"
+    std::optional<DataSource> get_data_source(std::string_view source) const;
     std::optional<Sample> get_test_sample(int index) const;
     std::optional<Sample> get_train_sample(int index) const;
+    // source is "test" or "train", nullptr otherwise
+    SampleCache* get_sample_cache(std::string_view source);
 
     Db db;
     MemMatrix train_inputs;
     MemMatrix train_labels;
     MemMatrix test_inputs;
     MemMatrix test_labels;
-};
+    // Encoded samples served by the data endpoints
+    SampleCache train_samples;
+    SampleCache test_samples;
+
+    // Predictions run on inference_pool and training on training_pool, so training load never
+    // queues in front of interactive requests
+    ComputePool inference_pool;
+    ComputePool training_pool;
+    // Time slices training jobs on training_pool
+    FairShare training_share;
 
-void to_json(json& j, const Sample& v);
+    ModelCache model_cache;
+    LiveModels live_models;
+    // Test set results of stored network versions, live snapshots are not evaluated
+    EvaluationCache evaluations;
+    PredictBatcher predict_batcher;
+};
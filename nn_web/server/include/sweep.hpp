@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+using nlohmann::json;
+
+// One network variant of a sweep
+struct SweepConfig {
+    std::vector<int> layer_sizes;
+    // One per layer after the input, the last one is the output activation
+    std::vector<std::string> activations;
+    std::string loss;
+    double learning_rate;
+    int batch_size;
+};
+
+void to_json(json& j, const SweepConfig& v);
+void from_json(const json& j, SweepConfig& v);
+
+struct SweepParams {
+    // Trial networks are named "<name>/<index>"
+    std::string name;
+    std::vector<SweepConfig> configs;
+    // Epochs every trial trains in the first rung. Each later rung trains the survivors up to
+    // reduction_factor times as many epochs in total, at most max_epochs
+    int min_epochs;
+    int max_epochs;
+    // Only the best 1 / reduction_factor of the trials move on to the next rung
+    int reduction_factor;
+    // Trials of this sweep training at once
+    int parallelism;
+    // Passed on to the training jobs
+    int priority;
+    double weight;
+};
+
+struct SweepTrial {
+    SweepConfig config;
+    int network_id;
+    // Epochs trained so far
+    int epochs = 0;
+    // Job training the current rung
+    std::optional<uint64_t> job_id;
+    // Test set results after the last rung the trial finished
+    std::optional<int> correct;
+    std::optional<double> cost;
+    // Rung after which the trial was dropped, nullopt while it is still in the race
+    std::optional<int> stopped_at_rung;
+    std::optional<std::string> error;
+};
+
+enum class SweepStatus {
+    Running,
+    Completed,
+    Failed,
+    Cancelled,
+};
+
+std::string_view sweep_status_to_str(SweepStatus status);
+
+// Point in time copy of a sweep, safe to read without its lock
+struct SweepInfo {
+    uint64_t id;
+    SweepParams params;
+    SweepStatus status;
+    int rung;
+    std::vector<SweepTrial> trials;
+    std::optional<int> best_network_id;
+    std::chrono::system_clock::time_point created_at;
+    std::optional<std::chrono::system_clock::time_point> finished_at;
+    std::optional<std::string> error;
+};
+
+void to_json(json& j, const SweepInfo& v);
+
+struct Sweep {
+    using Clock = std::chrono::system_clock;
+
+    SweepInfo info() const;
+
+    uint64_t id;
+    SweepParams params;
+    Clock::time_point created_at;
+    std::atomic<bool> cancel_requested = false;
+
+    // Written by the sweep runner
+    mutable std::mutex mutex;
+    SweepStatus status = SweepStatus::Running;
+    int rung = 0;
+    std::vector<SweepTrial> trials;
+    std::optional<int> best_network_id;
+    std::optional<Clock::time_point> finished_at;
+    std::optional<std::string> error;
+};
+
+// Successive halving: of the candidate trials with results, the best candidates.size() /
+// reduction_factor (at least one) by correct predictions, then by cost, best first
+std::vector<size_t> successive_halving_survivors(
+    const std::vector<SweepTrial>& trials, const std::vector<size_t>& candidates,
+    int reduction_factor
+);
+
+// Sweeps started since the server started, safe to use from any thread. Only the newest
+// finished sweeps are kept
+class SweepRegistry {
+public:
+    std::shared_ptr<Sweep> add(SweepParams params, std::vector<SweepTrial> trials);
+
+    std::shared_ptr<Sweep> get(uint64_t id) const;
+    // Newest first
+    std::vector<SweepInfo> list() const;
+
+private:
+    mutable std::mutex m_mutex;
+    uint64_t m_next_id = 1;
+    std::map<uint64_t, std::shared_ptr<Sweep>> m_sweeps;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// A finished span as stored in the ring buffer. Names and categories must be string literals,
+// only the pointers are kept
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    // Nanoseconds since the tracer was enabled
+    int64_t start_ns;
+    int64_t duration_ns;
+    uint32_t thread;
+    // Spans with an id are exported as async events grouped under it, so a request or training
+    // job shows up as one track even when its coroutine hops threads. 0 for plain spans
+    uint64_t id;
+    // Free form number shown with the span, such as a batch size
+    int64_t arg;
+};
+
+// Records spans into a fixed size ring buffer, overwriting the oldest, and exports them as Chrome
+// trace event JSON that chrome://tracing and Perfetto load. Recording takes a few relaxed atomic
+// operations and never blocks, a reader that races with a writer on a slot skips that event
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Allocates room for capacity events, 0 leaves tracing off. Call once at startup, before
+    // anything records
+    void enable(size_t capacity);
+    bool enabled() const {
+        return m_capacity != 0;
+    }
+
+    void record(
+        const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+        uint64_t id = 0, int64_t arg = 0
+    );
+
+    // Names the calling thread in exported traces
+    void set_thread_name(std::string name);
+
+    // The events currently in the buffer as a Chrome trace JSON document
+    std::string export_chrome_json() const;
+
+    uint64_t recorded() const;
+    size_t capacity() const;
+
+private:
+    struct Slot {
+        // Index of the event + 1 once it is written, 0 while a writer fills the slot
+        std::atomic<uint64_t> sequence = 0;
+        std::atomic<const char*> name = nullptr;
+        std::atomic<const char*> category = nullptr;
+        std::atomic<int64_t> start_ns = 0;
+        std::atomic<int64_t> duration_ns = 0;
+        std::atomic<uint32_t> thread = 0;
+        std::atomic<uint64_t> id = 0;
+        std::atomic<int64_t> arg = 0;
+    };
+
+    // Small sequential id of the calling thread
+    static uint32_t thread_id();
+
+    size_t m_capacity = 0;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<uint64_t> m_next = 0;
+    Clock::time_point m_epoch;
+
+    mutable std::mutex m_names_mutex;
+    std::unordered_map<uint32_t, std::string> m_thread_names;
+};
+
+// The process wide tracer
+Tracer& tracer();
+
+// Records a span from construction to destruction
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category, uint64_t id = 0, int64_t arg = 0)
+    : m_name(name), m_category(category), m_id(id), m_arg(arg) {
+        if (tracer().enabled()) {
+            m_start = Tracer::Clock::now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (tracer().enabled()) {
+            tracer().record(m_name, m_category, m_start, Tracer::Clock::now(), m_id, m_arg);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void set_arg(int64_t arg) {
+        m_arg = arg;
+    }
+
+private:
+    const char* m_name;
+    const char* m_category;
+    uint64_t m_id;
+    int64_t m_arg;
+    Tracer::Clock::time_point m_start;
+};
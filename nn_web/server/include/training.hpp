@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "asio/any_io_executor.hpp"
+#include "asio/awaitable.hpp"
+#include "db.hpp"
+#include "nlohmann/json.hpp"
+
+using nlohmann::json;
+
+enum class JobStatus {
+    Queued,
+    Running,
+    Completed,
+    Failed,
+    Cancelled,
+};
+
+std::string_view job_status_to_str(JobStatus status);
+
+struct TrainJobParams {
+    int network_id;
+    int epochs;
+    int batch_size;
+    double learning_rate;
+    std::optional<int> micro_batch_size;
+    // Higher runs first, ties run in submission order
+    int priority;
+    // Share of the training workers relative to the other running jobs
+    double weight;
+    // Set when resuming a job interrupted by a restart
+    std::shared_ptr<const Checkpoint> resume_from = nullptr;
+};
+
+// Without resume_from, which is stored next to the parameters
+void to_json(json& j, const TrainJobParams& v);
+void from_json(const json& j, TrainJobParams& v);
+
+struct TrainJob {
+    using Clock = std::chrono::system_clock;
+
+    uint64_t id;
+    TrainJobParams params;
+    Clock::time_point created_at;
+
+    // Written by the job runner
+    std::atomic<int> epochs_done = 0;
+    std::atomic<int64_t> batches_done = 0;
+    std::atomic<int64_t> total_batches = 0;
+    std::atomic<int64_t> samples_done = 0;
+    // Part of samples_done trained before a restart, left out of the throughput
+    std::atomic<int64_t> resumed_samples = 0;
+    // Time spent running on a training worker
+    std::atomic<double> busy_seconds = 0.0;
+    std::atomic<bool> cancel_requested = false;
+
+    // Guarded by the scheduler
+    JobStatus status = JobStatus::Queued;
+    std::optional<Clock::time_point> started_at;
+    std::optional<Clock::time_point> finished_at;
+    std::optional<std::string> error;
+};
+
+// Point in time copy of a job, safe to read without the scheduler lock
+struct TrainJobInfo {
+    uint64_t id;
+    TrainJobParams params;
+    JobStatus status;
+    int epochs_done;
+    int64_t batches_done;
+    int64_t total_batches;
+    int64_t samples_done;
+    int64_t resumed_samples;
+    double busy_seconds;
+    TrainJob::Clock::time_point created_at;
+    std::optional<TrainJob::Clock::time_point> started_at;
+    std::optional<TrainJob::Clock::time_point> finished_at;
+    std::optional<std::string> error;
+};
+
+void to_json(json& j, const TrainJobInfo& v);
+
+struct TrainingSchedulerStats {
+    size_t running;
+    size_t queued;
+    size_t max_running;
+    size_t max_queued;
+};
+
+enum class SubmitError {
+    QueueFull,
+    // The network already has a queued or running job
+    NetworkBusy,
+};
+
+enum class CancelResult {
+    NotFound,
+    AlreadyFinished,
+    Cancelled,
+};
+
+// Runs training jobs in the background, at most max_running at a time, which the runner is
+// expected to interleave on the training workers. Further jobs wait in a priority queue of at most
+// max_queued entries, submissions beyond that are rejected. A network has at most one queued or
+// running job, as jobs keep their checkpoint and live snapshot under the network id
+class TrainingScheduler {
+public:
+    // Trains the job's network, returning an error message on failure. It should check
+    // cancel_requested regularly and return early once it is set
+    using Runner =
+        std::function<asio::awaitable<std::expected<void, std::string>>(std::shared_ptr<TrainJob>)>;
+
+    TrainingScheduler(
+        asio::any_io_executor executor, size_t max_running, size_t max_queued, Runner runner
+    );
+
+    std::expected<TrainJobInfo, SubmitError> submit(const TrainJobParams& params);
+    CancelResult cancel(uint64_t id);
+    // Cancels the network's queued or running job, if any
+    void cancel_network(int network_id);
+
+    std::optional<TrainJobInfo> get(uint64_t id) const;
+    // Every job still known to the scheduler, newest first
+    std::vector<TrainJobInfo> list() const;
+
+    TrainingSchedulerStats stats() const;
+
+private:
+    // All expect m_mutex to be held
+    CancelResult cancel_job(TrainJob& job);
+    void start_queued();
+    void forget_old_jobs();
+
+    asio::awaitable<void> run(std::shared_ptr<TrainJob> job);
+
+    static TrainJobInfo info(const TrainJob& job);
+
+    asio::any_io_executor m_executor;
+    size_t m_max_running;
+    size_t m_max_queued;
+    Runner m_runner;
+
+    mutable std::mutex m_mutex;
+    uint64_t m_next_id = 1;
+    std::map<uint64_t, std::shared_ptr<TrainJob>> m_jobs;
+    // Ordered by descending priority, then id
+    std::set<std::pair<int, uint64_t>> m_queue;
+    size_t m_running = 0;
+    // Queued or running job of each network
+    std::map<int, uint64_t> m_network_jobs;
+    // Finished job ids, oldest first
+    std::deque<uint64_t> m_finished;
+};
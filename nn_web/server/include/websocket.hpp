@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "asio/awaitable.hpp"
+#include "asio/ip/tcp.hpp"
+
+// Sec-WebSocket-Accept value for a client's Sec-WebSocket-Key
+std::string websocket_accept_key(std::string_view key);
+
+struct WebSocketMessage {
+    enum class Type {
+        Text,
+        Binary,
+    };
+
+    Type type;
+    std::string data;
+};
+
+// Server side of a WebSocket connection (RFC 6455), without extensions. Not thread safe, every
+// call has to come from the same strand
+class WebSocket {
+public:
+    // Messages longer than this close the connection
+    static constexpr size_t MAX_MESSAGE_SIZE = 1 << 16;
+
+    explicit WebSocket(asio::ip::tcp::socket socket);
+
+    // Reads the HTTP upgrade request and completes the handshake, returning the requested path.
+    // Invalid requests get a 400 response and an error
+    asio::awaitable<std::expected<std::string, std::string>> accept();
+
+    // The next data message, reassembled from its fragments. Pings are answered while waiting,
+    // nullopt once the peer closed the connection
+    asio::awaitable<std::optional<WebSocketMessage>> read();
+
+    asio::awaitable<void> send_binary(std::string_view data);
+    asio::awaitable<void> send_text(std::string_view data);
+    // Sends a close frame, the socket is closed once the peer answers or read fails
+    asio::awaitable<void> close(uint16_t code, std::string_view reason = "");
+
+    asio::ip::tcp::socket& socket();
+
+private:
+    // Reads until the buffer holds at least size bytes
+    asio::awaitable<void> fill(size_t size);
+    asio::awaitable<void> send_frame(uint8_t opcode, std::string_view payload);
+
+    asio::ip::tcp::socket m_socket;
+    // Received bytes not consumed yet
+    std::string m_buffer;
+    bool m_close_sent = false;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Binary predict bodies, an alternative to JSON arrays for clients that send
+// application/octet-stream
+
+constexpr std::string_view OCTET_STREAM = "application/octet-stream";
+
+// Layout of a binary input, picked with the X-Input-Format header
+enum class InputFormat {
+    // One byte per pixel, 0-255
+    U8,
+    // One little-endian float32 per pixel, 0.0-1.0
+    F32,
+};
+
+std::optional<InputFormat> str_to_input_format(std::string_view s);
+
+// Decodes size values in the given format, inferring it from the body length when not given
+std::expected<Eigen::VectorXd, std::string> decode_input(
+    std::string_view body, std::optional<InputFormat> format, int size
+);
+
+// Little-endian float32 per value
+std::string encode_output(const Eigen::Ref<const Eigen::VectorXd>& output);
@@ -8,10 +8,18 @@
 #include <httc/server.hpp>
 #include <httc/status.hpp>
 #include <httc/utils/file_handlers.hpp>
+#include <deque>
+#include <map>
 #include <memory>
+#include <numeric>
+#include <thread>
 #include <nlohmann/json.hpp>
 #include <nn_lib/activation.hpp>
+#include <nn_lib/incremental.hpp>
 #include <nn_lib/network.hpp>
+#include <nn_lib/trainer.hpp>
+#include "tracing.hpp"
+#include "wire.hpp"
 
 using json = nlohmann::json;
 
@@ -43,35 +51,62 @@ void from_json(const json& j, AddNetworkRequest& req) {
     j.at("loss").get_to(req.loss);
 }
 
+// The only place request headers are read, keeps the httc header API in one spot
+std::optional<std::string_view> request_header(const httc::Request& req, std::string_view name) {
+    return req.headers.get(name);
+}
+
+json parse_body(const httc::Request& req) {
+    TraceSpan span("parse_json", "request", 0, req.body.size());
+    return json::parse(req.body);
+}
+
+bool accepts_binary(const httc::Request& req) {
+    auto accept = request_header(req, "Accept");
+    return accept && accept->find(OCTET_STREAM) != std::string_view::npos;
+}
+
+// Every handler gets its own response counters and latency histogram, labeled with its name, a
+// trace span per request from routing to the end of the response and a sampled access log record
 #define MAKE_API_ROUTE(method, handler) \
     method { \
-        [this](auto& req, auto& res) -> asio::awaitable<void> { \
+        [this, metrics = m_metrics.for_handler(#handler), \
+         access = m_access_log.for_handler(#handler)](auto& req, auto& res) \
+            -> asio::awaitable<void> { \
+            auto start = std::chrono::steady_clock::now(); \
+            TraceSpan span(#handler, "request", m_next_request_id++); \
+            size_t bytes_out; \
             if constexpr (requires { this->handler(req, res); }) { \
                 auto resp = co_await this->handler(req, res); \
-                resp.to_response(res); \
+                TraceSpan serialize_span("serialize", "request"); \
+                bytes_out = resp.to_response(res); \
             } else { \
                 auto resp = co_await this->handler(req); \
-                resp.to_response(res); \
+                TraceSpan serialize_span("serialize", "request"); \
+                bytes_out = resp.to_response(res); \
             } \
+            auto duration = std::chrono::steady_clock::now() - start; \
+            span.set_arg(res.status.code); \
+            metrics->observe(res.status.code, duration); \
+            m_access_log.log( \
+                #handler, *access, req.method, \
+                { req.uri.path(), res.status.code, duration, req.body.size(), bytes_out } \
+            ); \
             co_return; \
         } \
     }
 
-App::App(std::optional<std::string_view> static_assets_path)
-: m_static_assets_path(static_assets_path) {
-    m_state = std::make_shared<State>();
-    m_router = std::make_shared<httc::Router>();
-
-    // Logging middleware
-    m_router->wrap(
-        [](const httc::Request& req, httc::Response& res, auto next) -> asio::awaitable<void> {
-        spdlog::info("Incoming request: {} {}", req.method, req.uri.path());
-        co_await next(req, res);
-        spdlog::info("Response status: {}", res.status.code);
-
-        co_return;
+App::App(Config config) : m_config(std::move(config)), m_access_log(m_config) {
+    tracer().enable(m_config.trace_buffer_size);
+    m_state = std::make_shared<State>(m_config);
+    m_checkpoints = std::make_unique<CheckpointWriter>(m_state->db, m_io_ctx.get_executor());
+    m_training = std::make_unique<TrainingScheduler>(
+        m_io_ctx.get_executor(), m_config.training_jobs_max, m_config.training_queue_max,
+        [this](std::shared_ptr<TrainJob> job) {
+        return run_training_job(std::move(job));
     }
     );
+    m_router = std::make_shared<httc::Router>();
 
     // CORS middleware
     m_router->wrap(
@@ -88,13 +123,14 @@ App::App(std::optional<std::string_view> static_assets_path)
     // Add routes
     using namespace httc::methods;
 
-    if (m_static_assets_path) {
+    if (m_config.static_assets_path) {
         m_router->route(
-            "/", httc::utils::FileHandler(std::format("{}/index.html", *m_static_assets_path))
+            "/",
+            httc::utils::FileHandler(std::format("{}/index.html", *m_config.static_assets_path))
         );
         m_router->route(
             "/assets/*",
-            httc::utils::DirectoryHandler(std::format("{}/assets", *m_static_assets_path))
+            httc::utils::DirectoryHandler(std::format("{}/assets", *m_config.static_assets_path))
         );
     }
 
@@ -104,19 +140,370 @@ App::App(std::optional<std::string_view> static_assets_path)
     m_router->route("/api/networks/:id", MAKE_API_ROUTE(del, remove_network));
     m_router->route("/api/networks/:id/predict/:source/:idx", MAKE_API_ROUTE(post, predict));
     m_router->route("/api/networks/:id/predict", MAKE_API_ROUTE(post, predict_custom));
+    m_router->route(
+        "/api/networks/:id/predict_range/:source/:start/:count",
+        MAKE_API_ROUTE(post, predict_range)
+    );
+    m_router->route("/api/networks/:id/predict_batch", MAKE_API_ROUTE(post, predict_batch));
     m_router->route("/api/networks/:id/train", MAKE_API_ROUTE(post, train_network));
+    m_router->route("/api/compare", MAKE_API_ROUTE(post, compare_networks));
+
+    m_router->route("/api/jobs", MAKE_API_ROUTE(get, get_jobs));
+    m_router->route("/api/jobs/:id", MAKE_API_ROUTE(get, get_job));
+    m_router->route("/api/jobs/:id/cancel", MAKE_API_ROUTE(post, cancel_job));
+
+    m_router->route("/api/sweeps", MAKE_API_ROUTE(get, get_sweeps));
+    m_router->route("/api/sweeps", MAKE_API_ROUTE(post, create_sweep));
+    m_router->route("/api/sweeps/:id", MAKE_API_ROUTE(get, get_sweep));
+    m_router->route("/api/sweeps/:id/cancel", MAKE_API_ROUTE(post, cancel_sweep));
 
     m_router->route("/api/data/:source/:idx", MAKE_API_ROUTE(get, get_data));
+    m_router->route("/api/data/:source/:idx/png", MAKE_API_ROUTE(get, get_data_png));
+    m_router->route("/api/data_range/:source/:start/:count", MAKE_API_ROUTE(get, get_data_range));
+    m_router->route("/api/stats", MAKE_API_ROUTE(get, get_stats));
+    m_router->route("/metrics", MAKE_API_ROUTE(get, get_metrics));
+    m_router->route("/ready", MAKE_API_ROUTE(get, get_ready));
+    m_router->route("/api/admin/trace", MAKE_API_ROUTE(get, get_trace));
 }
 
 void App::run() {
-    asio::io_context io_ctx;
     int port = 8080;
 
-    spdlog::info("Listening on port {}", port);
-    httc::bind_and_listen("0.0.0.0", port, m_router, io_ctx);
+    spdlog::info("Listening on port {} with {} I/O threads", port, m_config.io_threads);
+    httc::bind_and_listen("0.0.0.0", port, m_router, m_io_ctx);
+    asio::co_spawn(m_io_ctx, resume_training(), asio::detached);
+    asio::co_spawn(m_io_ctx, evaluate_unevaluated_networks(), asio::detached);
+    if (m_config.warmup) {
+        asio::co_spawn(m_io_ctx, warm_up(), asio::detached);
+    } else {
+        m_ready = true;
+    }
+    if (m_config.ws_port != 0) {
+        asio::co_spawn(m_io_ctx, listen_websockets(), asio::detached);
+    }
+
+    // Joined when run returns
+    std::vector<std::jthread> io_threads;
+    io_threads.reserve(m_config.io_threads - 1);
+    for (int i = 1; i < m_config.io_threads; i++) {
+        io_threads.emplace_back([this, i]() {
+            tracer().set_thread_name(std::format("io-{}", i));
+            m_io_ctx.run();
+        });
+    }
+    tracer().set_thread_name("io-0");
+    m_io_ctx.run();
+}
+
+asio::awaitable<void> App::warm_up() {
+    auto start = std::chrono::steady_clock::now();
+    TraceSpan span("warm_up", "startup");
+
+    // Each mapping is read on its own training worker
+    const MemMatrix* mappings[] = { &m_state->train_inputs, &m_state->train_labels,
+                                    &m_state->test_inputs, &m_state->test_labels };
+    auto prefaulted = co_await m_state->training_pool.run_all(std::size(mappings), [&](int i) {
+        return mappings[i]->prefault();
+    });
+    size_t prefaulted_bytes = std::reduce(prefaulted.begin(), prefaulted.end(), size_t{ 0 });
+
+    // Networks carry no record of their last use, the newest ones stand in for the most recently
+    // used
+    size_t warmed_models = 0;
+    auto networks_res = co_await m_state->db.get_networks();
+    if (networks_res) {
+        auto networks = std::move(networks_res.value());
+        std::ranges::sort(networks, std::greater{}, &NetworkInfo::id);
+        networks.resize(std::min(networks.size(), m_config.warmup_models));
+
+        auto input = Eigen::VectorXd(m_state->test_inputs.mat().col(0));
+        for (const auto& network : networks) {
+            auto model = co_await load_model(network.id, false);
+            if (!model) {
+                continue;
+            }
+            // One prediction through the regular path pages in the weights and the inference code
+            co_await m_state->predict_batcher.predict(*model, input);
+            warmed_models++;
+        }
+    } else {
+        spdlog::error(
+            "Failed to retrieve networks to warm up: {} {}", networks_res.error().message,
+            networks_res.error().code
+        );
+    }
+
+    m_ready = true;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start
+    );
+    spdlog::info(
+        "Warm-up done in {} ms: prefaulted {} MiB of datasets, loaded {} networks",
+        elapsed.count(), prefaulted_bytes >> 20, warmed_models
+    );
+}
+
+asio::awaitable<void> App::listen_websockets() {
+    auto executor = co_await asio::this_coro::executor;
+    asio::ip::tcp::acceptor acceptor(executor);
+    try {
+        asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), m_config.ws_port);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to listen for WebSockets on port {}: {}", m_config.ws_port, e.what());
+        co_return;
+    }
+    spdlog::info("Listening for WebSockets on port {}", m_config.ws_port);
+
+    while (true) {
+        auto strand = asio::make_strand(m_io_ctx);
+        asio::ip::tcp::socket socket(strand);
+        try {
+            co_await acceptor.async_accept(socket, asio::use_awaitable);
+        } catch (const std::exception& e) {
+            spdlog::warn("Failed to accept WebSocket connection: {}", e.what());
+            continue;
+        }
+        asio::co_spawn(strand, predict_session(std::move(socket)), asio::detached);
+    }
+}
+
+// A prediction session and its idle watchdog, both run on the session's strand
+struct PredictSession {
+    WebSocket socket;
+    asio::steady_timer idle_timer;
+    bool done = false;
+};
+
+// Closes the socket once the idle timer expires without being pushed back
+asio::awaitable<void> watch_idle(std::shared_ptr<PredictSession> session) {
+    while (!session->done) {
+        asio::error_code ec;
+        co_await session->idle_timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        if (!ec && !session->done
+            && session->idle_timer.expiry() <= asio::steady_timer::clock_type::now()) {
+            asio::error_code close_ec;
+            session->socket.socket().close(close_ec);
+            co_return;
+        }
+    }
+}
+
+// Session URLs look like /api/networks/<id>/predict_ws
+std::optional<int> predict_session_network(std::string_view path) {
+    constexpr std::string_view PREFIX = "/api/networks/";
+    constexpr std::string_view SUFFIX = "/predict_ws";
+    if (!path.starts_with(PREFIX) || !path.ends_with(SUFFIX)
+        || path.size() <= PREFIX.size() + SUFFIX.size()) {
+        return std::nullopt;
+    }
+    auto id = path.substr(PREFIX.size(), path.size() - PREFIX.size() - SUFFIX.size());
+    try {
+        return std::stoi(std::string(id));
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+asio::awaitable<void> App::predict_session(asio::ip::tcp::socket socket) {
+    auto executor = co_await asio::this_coro::executor;
+    auto session = std::make_shared<PredictSession>(
+        PredictSession{ WebSocket(std::move(socket)), asio::steady_timer(executor) }
+    );
+    auto& ws = session->socket;
+    auto metrics = m_metrics.for_handler("predict_ws");
+
+    try {
+        session->idle_timer.expires_after(m_config.ws_idle_timeout);
+        asio::co_spawn(executor, watch_idle(session), asio::detached);
+
+        auto path = co_await ws.accept();
+        if (!path) {
+            spdlog::info("Rejected WebSocket connection: {}", path.error());
+            session->done = true;
+            session->idle_timer.cancel();
+            co_return;
+        }
+
+        auto network_id = predict_session_network(*path);
+        if (!network_id) {
+            co_await ws.close(1008, "Unknown path");
+        }
+        // Resolved once, the session keeps predicting with this version
+        std::shared_ptr<const Model> model;
+        if (network_id) {
+            auto model_res = co_await load_model(*network_id);
+            if (model_res) {
+                model = *model_res;
+            } else {
+                co_await ws.close(1008, "Network not found");
+            }
+        }
+        // Consecutive frames of a drawing differ in a few pixels, only those are fed through the
+        // first layer again
+        std::optional<nn::IncrementalPredictor> predictor;
+        if (model) {
+            predictor.emplace(model->network);
+            spdlog::info("Started prediction session for network {}", model->id);
+        }
+
+        while (true) {
+            session->idle_timer.expires_after(m_config.ws_idle_timeout);
+            auto message = co_await ws.read();
+            if (!message) {
+                break;
+            }
+            // Only reachable after a close was sent, while waiting for the peer to answer it
+            if (!model) {
+                continue;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            TraceSpan span("predict_ws", "request", m_next_request_id++);
+            std::expected<Eigen::VectorXd, std::string> input =
+                std::unexpected(std::string("Expected binary frames"));
+            if (message->type == WebSocketMessage::Type::Binary) {
+                input = decode_input(message->data, std::nullopt, model->layer_sizes.front());
+            }
+            if (!input) {
+                auto error = json{ { "error", input.error() } }.dump();
+                co_await ws.send_text(error);
+                metrics->observe(400, std::chrono::steady_clock::now() - start);
+                continue;
+            }
+
+            auto output = co_await m_state->inference_pool.run([&]() -> Eigen::VectorXd {
+                TraceSpan span("feed_forward_incremental", "inference", 0, 1);
+                return predictor->predict(*input);
+            });
+            co_await ws.send_binary(encode_output(output));
+            metrics->observe(200, std::chrono::steady_clock::now() - start);
+        }
+        if (model) {
+            spdlog::info("Ended prediction session for network {}", model->id);
+        }
+    } catch (const std::exception& e) {
+        spdlog::info("Prediction session closed: {}", e.what());
+    }
 
-    io_ctx.run();
+    session->done = true;
+    session->idle_timer.cancel();
+}
+
+asio::awaitable<void> App::resume_training() {
+    auto checkpoints_res = co_await m_state->db.get_checkpoints();
+    if (!checkpoints_res) {
+        spdlog::error(
+            "Failed to load training checkpoints: {} {}", checkpoints_res.error().message,
+            checkpoints_res.error().code
+        );
+        co_return;
+    }
+
+    for (auto& checkpoint : checkpoints_res.value()) {
+        TrainJobParams params;
+        try {
+            json::parse(checkpoint.job_params).get_to(params);
+        } catch (const std::exception& e) {
+            spdlog::error(
+                "Discarding checkpoint of network {} with invalid job parameters: {}",
+                checkpoint.network_id, e.what()
+            );
+            m_checkpoints->discard(checkpoint.network_id);
+            continue;
+        }
+        params.resume_from = std::make_shared<const Checkpoint>(std::move(checkpoint));
+
+        auto job = m_training->submit(params);
+        if (!job) {
+            spdlog::warn(
+                "Training queue full, not resuming the job of network {}", params.network_id
+            );
+            continue;
+        }
+        spdlog::info("Resuming training of network {} as job {}", params.network_id, job->id);
+    }
+}
+
+void App::schedule_evaluation(std::shared_ptr<const Model> model) {
+    if (model->live || !m_state->evaluations.try_start(model->id, model->version)) {
+        return;
+    }
+    asio::co_spawn(m_io_ctx, evaluate(std::move(model)), asio::detached);
+}
+
+asio::awaitable<std::shared_ptr<const Evaluation>> App::evaluate(
+    std::shared_ptr<const Model> model
+) {
+    // A single large batch, run on the training pool so it does not hold up interactive
+    // predictions
+    auto inputs = m_state->test_inputs.mat();
+    auto labels = m_state->test_labels.mat();
+    auto evaluation = co_await m_state->training_pool.run([&]() {
+        return std::make_shared<const Evaluation>(Evaluation::compute(*model, inputs, labels));
+    });
+    // Dropped when the weights changed or the network was deleted in the meantime, its results
+    // no longer describe the stored network
+    if (!m_state->evaluations.put(evaluation)) {
+        co_return evaluation;
+    }
+
+    auto update_res = co_await m_state->db.update_network_evaluation(
+        model->id, model->version, evaluation->correct, evaluation->cost
+    );
+    if (!update_res) {
+        spdlog::error(
+            "Failed to store evaluation of network {}: {} {}", model->id,
+            update_res.error().message, update_res.error().code
+        );
+        co_return evaluation;
+    }
+    spdlog::info(
+        "Evaluated network {} version {}: {}/{} correct, cost {}", model->id, model->version,
+        evaluation->correct, evaluation->outputs.cols(), evaluation->cost
+    );
+    co_return evaluation;
+}
+
+asio::awaitable<std::shared_ptr<const Evaluation>> App::evaluation_of(
+    std::shared_ptr<const Model> model
+) {
+    if (auto evaluation = m_state->evaluations.get(model->id, model->version)) {
+        co_return evaluation;
+    }
+    if (model->live || !m_state->evaluations.try_start(model->id, model->version)) {
+        // Evaluated elsewhere right now, running it again costs less than waiting for it
+        auto inputs = m_state->test_inputs.mat();
+        auto labels = m_state->test_labels.mat();
+        co_return co_await m_state->training_pool.run([&]() {
+            return std::make_shared<const Evaluation>(Evaluation::compute(*model, inputs, labels));
+        });
+    }
+    co_return co_await evaluate(std::move(model));
+}
+
+asio::awaitable<void> App::evaluate_unevaluated_networks() {
+    auto networks_res = co_await m_state->db.get_networks();
+    if (!networks_res) {
+        spdlog::error(
+            "Failed to retrieve networks to evaluate: {} {}", networks_res.error().message,
+            networks_res.error().code
+        );
+        co_return;
+    }
+
+    for (const auto& network : networks_res.value()) {
+        if (network.cost != 0.0) {
+            continue;
+        }
+        auto model = co_await load_model(network.id, false);
+        if (model) {
+            schedule_evaluation(*model);
+        }
+    }
 }
 
 asio::awaitable<ApiResponse> App::get_networks(const httc::Request& req) {
@@ -157,55 +544,57 @@ asio::awaitable<ApiResponse> App::get_network_by_id(const httc::Request& req) {
     co_return ApiResponse::ok(network_res.value().value());
 }
 
-asio::awaitable<ApiResponse> App::create_network(const httc::Request& req) {
-    json j = json::parse(req.body);
-    AddNetworkRequest add_req = j.get<AddNetworkRequest>();
-
+// A randomly initialized network for the request and the row that stores it
+std::expected<std::pair<nn::Network, AddNetwork>, ApiResponse> new_network(
+    const AddNetworkRequest& add_req
+) {
     if (add_req.name.length() < 2) {
-        co_return ApiResponse::field_error(
+        return std::unexpected(ApiResponse::field_error(
             { .field = "name", .error = "Name must be at least 2 characters long" }
-        );
+        ));
     }
     if (add_req.name.length() > 32) {
-        co_return ApiResponse::field_error(
+        return std::unexpected(ApiResponse::field_error(
             { .field = "name", .error = "Name must be less than 32 characters long" }
-        );
+        ));
     }
 
     if (add_req.activations.size() + 1 != add_req.layer_sizes.size()) {
-        co_return ApiResponse::field_error(
+        return std::unexpected(ApiResponse::field_error(
             { .field = "activations",
               .error = "Number of activations must be one less than number of layers" }
-        );
+        ));
     }
 
     auto hidden_activations_view =
         add_req.activations | std::views::take(add_req.activations.size() - 1);
     auto hidden_activations_opt = nn::strs_to_hidden_activation(hidden_activations_view);
     if (!hidden_activations_opt) {
-        co_return ApiResponse::field_error(
+        return std::unexpected(ApiResponse::field_error(
             { .field = "activations", .error = "Invalid activation functions in hidden layers" }
-        );
+        ));
     }
 
     auto output_activation_req = add_req.activations.back();
     auto output_activation_opt = nn::str_to_output_activation(output_activation_req);
     if (!output_activation_opt) {
-        co_return ApiResponse::field_error(
+        return std::unexpected(ApiResponse::field_error(
             { .field = "activations", .error = "Invalid activation function in output layer" }
-        );
+        ));
     }
 
     auto layer_error = validate_network_layers(add_req.layer_sizes);
     if (layer_error) {
-        co_return ApiResponse::field_error(*layer_error);
+        return std::unexpected(ApiResponse::field_error(*layer_error));
     }
 
     auto output_activation = output_activation_opt.value();
 
     auto loss_opt = nn::str_to_loss(add_req.loss);
     if (!loss_opt) {
-        co_return ApiResponse::field_error({ .field = "loss", .error = "Invalid loss function" });
+        return std::unexpected(
+            ApiResponse::field_error({ .field = "loss", .error = "Invalid loss function" })
+        );
     }
     auto loss = loss_opt.value();
 
@@ -214,7 +603,7 @@ asio::awaitable<ApiResponse> App::create_network(const httc::Request& req) {
     );
     if (!network_opt.has_value()) {
         spdlog::error("Invlid network configuration");
-        co_return ApiResponse::internal_error("Failed to create network");
+        return std::unexpected(ApiResponse::internal_error("Failed to create network"));
     }
     auto network = network_opt.value();
 
@@ -226,6 +615,19 @@ asio::awaitable<ApiResponse> App::create_network(const httc::Request& req) {
     db_network.weights = network.dump_weights();
     db_network.biases = network.dump_biases();
 
+    return std::pair{ std::move(network), std::move(db_network) };
+}
+
+asio::awaitable<ApiResponse> App::create_network(const httc::Request& req) {
+    json j = parse_body(req);
+    AddNetworkRequest add_req = j.get<AddNetworkRequest>();
+
+    auto new_res = new_network(add_req);
+    if (!new_res) {
+        co_return new_res.error();
+    }
+    auto& [network, db_network] = *new_res;
+
     auto add_res = co_await m_state->db.add_network(std::move(db_network));
     if (!add_res) {
         if (add_res.error().code == SQLITE_CONSTRAINT_UNIQUE) {
@@ -240,6 +642,9 @@ asio::awaitable<ApiResponse> App::create_network(const httc::Request& req) {
             co_return ApiResponse::internal_error("Failed to add network");
         }
     }
+    schedule_evaluation(std::make_shared<const Model>(
+        Model{ add_res.value(), 0, add_req.layer_sizes, std::move(network) }
+    ));
 
     co_return ApiResponse{ httc::StatusCode::CREATED,
                            json{ { "message", "Network created successfully" } } };
@@ -266,6 +671,12 @@ asio::awaitable<ApiResponse> App::remove_network(const httc::Request& req) {
         spdlog::info("Network with id {} not found", network_id);
         co_return ApiResponse::not_found("Network not found");
     }
+    // The job's own discard once it stops drops any checkpoint it saves in the meantime
+    m_training->cancel_network(network_id);
+    m_state->model_cache.invalidate(network_id);
+    m_state->live_models.remove(network_id);
+    m_state->evaluations.invalidate(network_id);
+    m_checkpoints->discard(network_id);
 
     co_return ApiResponse::ok(json{ { "message", "Network deleted successfully" } });
 }
@@ -302,44 +713,30 @@ asio::awaitable<ApiResponse> App::predict(const httc::Request& req) {
         co_return ApiResponse::not_found("Training sample not found");
     }
 
-    auto network_res = co_await m_state->db.get_full_network_by_id(network_id);
-    if (!network_res) {
-        spdlog::error(
-            "Failed to retrieve network with id {}: {} {}", network_id, network_res.error().message,
-            network_res.error().code
-        );
-        co_return ApiResponse::internal_error("Failed to retrieve network");
-    }
-    if (!network_res.value()) {
-        spdlog::info("Network with id {} not found", network_id);
-        co_return ApiResponse::not_found("Network not found");
+    auto model = co_await load_model(network_id);
+    if (!model) {
+        co_return model.error();
     }
-    auto network_info = network_res.value().value();
 
-    auto hidden_activations_view =
-        network_info.activations | std::views::take(network_info.activations.size() - 1);
-    auto output_activation_str = network_info.activations.back();
-
-    // Should never be invalid since it was validated on insertion
-    auto hidden_activations = nn::strs_to_hidden_activation(hidden_activations_view).value();
-    auto output_activation = nn::str_to_output_activation(output_activation_str).value();
-    auto loss = nn::str_to_loss(network_info.loss).value();
-
-    auto network_opt = nn::Network::from_data(
-        network_info.layer_sizes, network_info.weights, network_info.biases, hidden_activations,
-        output_activation, loss
-    );
-    auto network = network_opt.value();
+    // Test set outputs of stored versions come from their evaluation once it is done
+    if (source == "test" && !(*model)->live) {
+        if (auto evaluation = m_state->evaluations.get(network_id, (*model)->version)) {
+            auto output = evaluation->outputs.col(index);
+            co_return ApiResponse::ok(json{
+                { "output", std::vector<double>(output.data(), output.data() + output.size()) },
+                { "loss", evaluation->losses(index) },
+            });
+        }
+        schedule_evaluation(*model);
+    }
 
     auto sample = sample_res.value();
-    auto prediction = network.predict(sample.input, sample.label);
+    auto output = co_await m_state->predict_batcher.predict(*model, sample.input.col(0));
+    auto loss = (*model)->network.output_loss(output, sample.label);
 
     co_return ApiResponse::ok(
-        json{ { "output",
-                std::vector<double>(
-                    prediction.output.data(), prediction.output.data() + prediction.output.size()
-                ) },
-              { "loss", prediction.loss } }
+        json{ { "output", std::vector<double>(output.data(), output.data() + output.size()) },
+              { "loss", loss } }
     );
 }
 
@@ -352,53 +749,198 @@ asio::awaitable<ApiResponse> App::predict_custom(const httc::Request& req) {
         co_return ApiResponse::bad_request("Invalid network ID");
     }
 
-    json j = json::parse(req.body);
-    std::vector<double> input = j.at("input").get<std::vector<double>>();
-    if (input.size() != 784) {
-        co_return ApiResponse::bad_request("Input size must be 784");
+    Eigen::VectorXd input_vector;
+    auto content_type = request_header(req, "Content-Type");
+    if (content_type && content_type->starts_with(OCTET_STREAM)) {
+        std::optional<InputFormat> format;
+        if (auto format_str = request_header(req, "X-Input-Format")) {
+            format = str_to_input_format(*format_str);
+            if (!format) {
+                co_return ApiResponse::bad_request("X-Input-Format must be u8 or f32");
+            }
+        }
+
+        auto input_res = decode_input(req.body, format, IMAGE_SIZE);
+        if (!input_res) {
+            co_return ApiResponse::bad_request(input_res.error());
+        }
+        input_vector = std::move(*input_res);
+    } else {
+        json j = parse_body(req);
+        std::vector<double> input = j.at("input").get<std::vector<double>>();
+        if (input.size() != 784) {
+            co_return ApiResponse::bad_request("Input size must be 784");
+        }
+        input_vector = Eigen::Map<Eigen::VectorXd>(input.data(), input.size());
     }
 
-    auto network_res = co_await m_state->db.get_full_network_by_id(network_id);
-    if (!network_res) {
-        spdlog::error(
-            "Failed to retrieve network with id {}: {} {}", network_id, network_res.error().message,
-            network_res.error().code
-        );
-        co_return ApiResponse::internal_error("Failed to retrieve network");
+    auto model = co_await load_model(network_id);
+    if (!model) {
+        co_return model.error();
     }
-    if (!network_res.value()) {
-        spdlog::info("Network with id {} not found", network_id);
-        co_return ApiResponse::not_found("Network not found");
+
+    auto output = co_await m_state->predict_batcher.predict(*model, std::move(input_vector));
+
+    if (accepts_binary(req)) {
+        co_return ApiResponse::ok_raw(std::string(OCTET_STREAM), encode_output(output));
     }
-    auto network_info = network_res.value().value();
+    co_return ApiResponse::ok(
+        json{ { "output", std::vector<double>(output.data(), output.data() + output.size()) } }
+    );
+}
 
-    auto hidden_activations_view =
-        network_info.activations | std::views::take(network_info.activations.size() - 1);
-    auto output_activation_str = network_info.activations.back();
+// Samples fed forward at once by the bulk prediction endpoints
+constexpr int PREDICT_CHUNK_SIZE = 1024;
+// Most inputs accepted in one predict_batch upload
+constexpr size_t MAX_BATCH_INPUTS = 10000;
 
-    // Should never be invalid since it was validated on insertion
-    auto hidden_activations = nn::strs_to_hidden_activation(hidden_activations_view).value();
-    auto output_activation = nn::str_to_output_activation(output_activation_str).value();
-    auto loss = nn::str_to_loss(network_info.loss).value();
+int argmax(const Eigen::Ref<const Eigen::VectorXd>& v) {
+    int index;
+    v.maxCoeff(&index);
+    return index;
+}
+
+// Feeds inputs forward chunk by chunk on the thread pool, writing one JSON line per sample. With
+// labels, every line also says whether the prediction was correct and a summary line follows
+asio::awaitable<void> stream_predictions(
+    httc::Response::ChunkedStream& stream, asio::any_io_executor executor,
+    const nn::Network& network, Eigen::Ref<const Eigen::MatrixXd> inputs,
+    std::optional<Eigen::Ref<const Eigen::MatrixXd>> labels, int first_index
+) {
+    int count = inputs.cols();
+    int correct = 0;
+    double total_loss = 0.0;
+
+    for (int offset = 0; offset < count; offset += PREDICT_CHUNK_SIZE) {
+        int chunk_size = std::min(PREDICT_CHUNK_SIZE, count - offset);
+        auto outputs = co_await asio::co_spawn(executor, [&]() -> asio::awaitable<Eigen::MatrixXd> {
+            TraceSpan span("feed_forward", "inference", 0, chunk_size);
+            co_return network.feed_forward(inputs.middleCols(offset, chunk_size));
+        }, asio::use_awaitable);
+
+        std::string lines;
+        for (int i = 0; i < chunk_size; i++) {
+            auto output = outputs.col(i);
+            int predicted = argmax(output);
+            json line{
+                { "index", first_index + offset + i },
+                { "output", std::vector<double>(output.data(), output.data() + output.size()) },
+                { "predicted", predicted },
+            };
+            if (labels) {
+                auto label = labels->col(offset + i);
+                int expected = argmax(label);
+                double loss = network.output_loss(output, label);
+                line["expected"] = expected;
+                line["correct"] = predicted == expected;
+                line["loss"] = loss;
+                correct += predicted == expected;
+                total_loss += loss;
+            }
+            lines += line.dump();
+            lines += '\n';
+        }
+        co_await stream.write(lines);
+    }
 
-    auto network_opt = nn::Network::from_data(
-        network_info.layer_sizes, network_info.weights, network_info.biases, hidden_activations,
-        output_activation, loss
+    if (labels) {
+        json summary{
+            { "count", count },
+            { "correct", correct },
+            { "loss", count > 0 ? total_loss / count : 0.0 },
+        };
+        co_await stream.write(summary.dump() + "\n");
+    }
+}
+
+asio::awaitable<ApiResponse> App::predict_range(const httc::Request& req, httc::Response& res) {
+    int network_id, start, count;
+    try {
+        network_id = std::stoi(req.path_params.at("id"));
+        start = std::stoi(req.path_params.at("start"));
+        count = std::stoi(req.path_params.at("count"));
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid network ID or range");
+    }
+
+    auto source = req.path_params.at("source");
+    auto data = m_state->get_data_source(source);
+    if (!data) {
+        co_return ApiResponse::bad_request("Invalid source");
+    }
+    if (start < 0 || count < 1 || start > data->inputs.cols() - count) {
+        co_return ApiResponse::bad_request("Range out of bounds");
+    }
+
+    auto model = co_await load_model(network_id);
+    if (!model) {
+        co_return model.error();
+    }
+
+    auto stream = co_await ApiResponse::stream(res, httc::StatusCode::OK, "application/x-ndjson");
+    co_await stream_predictions(
+        stream, m_state->inference_pool.executor(), (*model)->network,
+        data->inputs.middleCols(start, count), data->labels.middleCols(start, count), start
     );
-    auto network = network_opt.value();
 
-    auto input_matrix = Eigen::Map<Eigen::Matrix<double, 784, 1>>(input.data());
-    auto output = network.feed_forward(input_matrix);
+    co_return ApiResponse::stream_end();
+}
 
-    co_return ApiResponse::ok(
-        json{ { "output", std::vector<double>(output.data(), output.data() + output.size()) } }
+asio::awaitable<ApiResponse> App::predict_batch(const httc::Request& req, httc::Response& res) {
+    int network_id;
+    try {
+        network_id = std::stoi(req.path_params.at("id"));
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid network ID");
+    }
+
+    Eigen::MatrixXd inputs;
+    try {
+        json j = parse_body(req);
+        const auto& inputs_json = j.at("inputs");
+        if (!inputs_json.is_array() || inputs_json.empty()) {
+            co_return ApiResponse::bad_request("Inputs must be a non-empty array");
+        }
+        if (inputs_json.size() > MAX_BATCH_INPUTS) {
+            co_return ApiResponse::bad_request(
+                std::format("At most {} inputs are accepted", MAX_BATCH_INPUTS)
+            );
+        }
+
+        inputs.resize(IMAGE_SIZE, inputs_json.size());
+        for (size_t i = 0; i < inputs_json.size(); i++) {
+            const auto& input = inputs_json[i];
+            if (!input.is_array() || input.size() != IMAGE_SIZE) {
+                co_return ApiResponse::bad_request("Input size must be 784");
+            }
+            for (int r = 0; r < IMAGE_SIZE; r++) {
+                inputs(r, i) = input[r].get<double>();
+            }
+        }
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid JSON body");
+    }
+
+    auto model = co_await load_model(network_id);
+    if (!model) {
+        co_return model.error();
+    }
+
+    auto stream = co_await ApiResponse::stream(res, httc::StatusCode::OK, "application/x-ndjson");
+    co_await stream_predictions(
+        stream, m_state->inference_pool.executor(), (*model)->network, inputs, std::nullopt, 0
     );
+
+    co_return ApiResponse::stream_end();
 }
 
 struct TrainRequest {
     int epochs = 1;
     int batch_size = 32;
     double learning_rate = 0.01;
+    std::optional<int> micro_batch_size;
+    int priority = 0;
+    double weight = 1.0;
 };
 
 void from_json(const json& j, TrainRequest& req) {
@@ -408,9 +950,168 @@ void from_json(const json& j, TrainRequest& req) {
         j.at("batch_size").get_to(req.batch_size);
     if (j.contains("learning_rate"))
         j.at("learning_rate").get_to(req.learning_rate);
+    if (j.contains("micro_batch_size"))
+        req.micro_batch_size = j.at("micro_batch_size").get<int>();
+    if (j.contains("priority"))
+        j.at("priority").get_to(req.priority);
+    if (j.contains("weight"))
+        j.at("weight").get_to(req.weight);
+}
+
+// Most networks and inputs compared in one request
+constexpr size_t MAX_COMPARE_NETWORKS = 16;
+constexpr size_t MAX_COMPARE_INPUTS = 1000;
+
+json output_columns(const Eigen::Ref<const Eigen::MatrixXd>& outputs) {
+    json columns = json::array();
+    for (int i = 0; i < outputs.cols(); i++) {
+        auto output = outputs.col(i);
+        columns.push_back(std::vector<double>(output.data(), output.data() + output.size()));
+    }
+    return columns;
 }
 
-asio::awaitable<ApiResponse> App::train_network(const httc::Request& req, httc::Response& res) {
+std::vector<int> output_predictions(const Eigen::Ref<const Eigen::MatrixXd>& outputs) {
+    std::vector<int> predictions(outputs.cols());
+    for (int i = 0; i < outputs.cols(); i++) {
+        predictions[i] = argmax(outputs.col(i));
+    }
+    return predictions;
+}
+
+asio::awaitable<ApiResponse> App::compare_networks(const httc::Request& req) {
+    std::vector<int> network_ids;
+    bool ensemble;
+    Eigen::MatrixXd inputs;
+    // Only known for dataset samples
+    std::optional<Eigen::MatrixXd> labels;
+    try {
+        json j = parse_body(req);
+        j.at("networks").get_to(network_ids);
+        ensemble = j.value("ensemble", false);
+        if (network_ids.empty() || network_ids.size() > MAX_COMPARE_NETWORKS) {
+            co_return ApiResponse::bad_request(
+                std::format("Between 1 and {} networks can be compared", MAX_COMPARE_NETWORKS)
+            );
+        }
+
+        // Either dataset samples by index or uploaded inputs, gathered once for every network
+        if (j.contains("source")) {
+            auto source = j.at("source").get<std::string>();
+            auto indices = j.at("indices").get<std::vector<int>>();
+            auto data = m_state->get_data_source(source);
+            if (!data) {
+                co_return ApiResponse::bad_request("Invalid source");
+            }
+            if (indices.empty() || indices.size() > MAX_COMPARE_INPUTS) {
+                co_return ApiResponse::bad_request(
+                    std::format("Between 1 and {} indices are accepted", MAX_COMPARE_INPUTS)
+                );
+            }
+
+            inputs.resize(IMAGE_SIZE, indices.size());
+            labels.emplace(LABEL_SIZE, indices.size());
+            for (size_t i = 0; i < indices.size(); i++) {
+                if (indices[i] < 0 || indices[i] >= data->inputs.cols()) {
+                    co_return ApiResponse::bad_request("Index out of bounds");
+                }
+                inputs.col(i) = data->inputs.col(indices[i]);
+                labels->col(i) = data->labels.col(indices[i]);
+            }
+        } else {
+            const auto& inputs_json = j.at("inputs");
+            if (!inputs_json.is_array() || inputs_json.empty()
+                || inputs_json.size() > MAX_COMPARE_INPUTS) {
+                co_return ApiResponse::bad_request(
+                    std::format("Between 1 and {} inputs are accepted", MAX_COMPARE_INPUTS)
+                );
+            }
+
+            inputs.resize(IMAGE_SIZE, inputs_json.size());
+            for (size_t i = 0; i < inputs_json.size(); i++) {
+                const auto& input = inputs_json[i];
+                if (!input.is_array() || input.size() != IMAGE_SIZE) {
+                    co_return ApiResponse::bad_request("Input size must be 784");
+                }
+                for (int r = 0; r < IMAGE_SIZE; r++) {
+                    inputs(r, i) = input[r].get<double>();
+                }
+            }
+        }
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid JSON body");
+    }
+
+    std::vector<std::shared_ptr<const Model>> models;
+    for (int network_id : network_ids) {
+        auto model = co_await load_model(network_id);
+        if (!model) {
+            co_return model.error();
+        }
+        models.push_back(std::move(*model));
+    }
+
+    // Every network runs on its own inference thread, all reading the same inputs
+    auto outputs = co_await m_state->inference_pool.run_all(
+        models.size(),
+        [&](int i) -> Eigen::MatrixXd {
+            TraceSpan span("feed_forward", "inference", 0, inputs.cols());
+            return models[i]->network.feed_forward(inputs);
+        }
+    );
+
+    std::optional<std::vector<int>> expected;
+    if (labels) {
+        expected = output_predictions(*labels);
+    }
+    auto count_correct = [&](const std::vector<int>& predictions) {
+        int correct = 0;
+        for (size_t i = 0; i < predictions.size(); i++) {
+            correct += predictions[i] == (*expected)[i];
+        }
+        return correct;
+    };
+
+    json networks_json = json::array();
+    for (size_t i = 0; i < models.size(); i++) {
+        auto predictions = output_predictions(outputs[i]);
+        json network_json{
+            { "id", models[i]->id },
+            { "version", models[i]->version },
+            { "outputs", output_columns(outputs[i]) },
+            { "predicted", predictions },
+        };
+        if (labels) {
+            network_json["correct"] = count_correct(predictions);
+            network_json["loss"] = models[i]->network.output_loss(outputs[i], *labels);
+        }
+        networks_json.push_back(std::move(network_json));
+    }
+
+    json resp{ { "networks", std::move(networks_json) } };
+    if (expected) {
+        resp["expected"] = *expected;
+    }
+    if (ensemble) {
+        auto mean = nn::average_outputs(outputs);
+        if (!mean) {
+            co_return ApiResponse::bad_request("Networks have different output sizes");
+        }
+        auto predictions = output_predictions(*mean);
+        json ensemble_json{
+            { "outputs", output_columns(*mean) },
+            { "predicted", predictions },
+        };
+        if (labels) {
+            ensemble_json["correct"] = count_correct(predictions);
+        }
+        resp["ensemble"] = std::move(ensemble_json);
+    }
+
+    co_return ApiResponse::ok(std::move(resp));
+}
+
+asio::awaitable<ApiResponse> App::train_network(const httc::Request& req) {
     int network_id;
     try {
         network_id = std::stoi(req.path_params.at("id"));
@@ -421,97 +1122,864 @@ asio::awaitable<ApiResponse> App::train_network(const httc::Request& req, httc::
     TrainRequest train_req;
     try {
         if (!req.body.empty()) {
-            json j = json::parse(req.body);
+            json j = parse_body(req);
             train_req = j.get<TrainRequest>();
         }
     } catch (...) {
         co_return ApiResponse::bad_request("Invalid JSON body");
     }
+    if (train_req.micro_batch_size && *train_req.micro_batch_size < 1) {
+        co_return ApiResponse::bad_request("Micro batch size must be positive");
+    }
 
-    auto network_res = co_await m_state->db.get_full_network_by_id(network_id);
-    if (!network_res) {
-        co_return ApiResponse::internal_error("Failed to retrieve network");
+    if (train_req.epochs < 1 || train_req.batch_size < 1) {
+        co_return ApiResponse::bad_request("Epochs and batch size must be positive");
     }
-    if (!network_res.value()) {
-        co_return ApiResponse::not_found("Network not found");
+    if (!(train_req.weight > 0)) {
+        co_return ApiResponse::bad_request("Weight must be positive");
     }
-    auto network_info = network_res.value().value();
 
-    auto hidden_activations_view =
-        network_info.activations | std::views::take(network_info.activations.size() - 1);
-    auto hidden_activations = nn::strs_to_hidden_activation(hidden_activations_view).value();
-    auto output_activation = nn::str_to_output_activation(network_info.activations.back()).value();
-    auto loss = nn::str_to_loss(network_info.loss).value();
-
-    auto network_opt = nn::Network::from_data(
-        network_info.layer_sizes, network_info.weights, network_info.biases, hidden_activations,
-        output_activation, loss
-    );
-    if (!network_opt) {
-        co_return ApiResponse::internal_error("Failed to parse network from db");
+    // Fail fast on unknown networks instead of queueing a job that can only fail
+    auto model = co_await load_model(network_id);
+    if (!model) {
+        co_return model.error();
     }
-    auto network = network_opt.value();
 
-    auto inputs = m_state->train_inputs.mat();
-    auto labels = m_state->train_labels.mat();
+    auto job = m_training->submit(TrainJobParams{
+        .network_id = network_id,
+        .epochs = train_req.epochs,
+        .batch_size = train_req.batch_size,
+        .learning_rate = train_req.learning_rate,
+        .micro_batch_size = train_req.micro_batch_size,
+        .priority = train_req.priority,
+        .weight = train_req.weight,
+    });
+    if (!job && job.error() == SubmitError::NetworkBusy) {
+        co_return ApiResponse::error(
+            httc::StatusCode::CONFLICT, "Network already has a queued or running training job"
+        );
+    }
+    if (!job) {
+        co_return ApiResponse::error(
+            httc::StatusCode::TOO_MANY_REQUESTS, "Training queue is full, try again later"
+        );
+    }
+
+    co_return ApiResponse::accepted(*job);
+}
+
+asio::awaitable<ApiResponse> App::get_jobs(const httc::Request& req) {
+    co_return ApiResponse::ok(m_training->list());
+}
+
+asio::awaitable<ApiResponse> App::get_job(const httc::Request& req) {
+    uint64_t job_id;
+    try {
+        job_id = std::stoull(req.path_params.at("id"));
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid job ID");
+    }
+
+    auto job = m_training->get(job_id);
+    if (!job) {
+        co_return ApiResponse::not_found("Job not found");
+    }
+    co_return ApiResponse::ok(*job);
+}
+
+asio::awaitable<ApiResponse> App::cancel_job(const httc::Request& req) {
+    uint64_t job_id;
+    try {
+        job_id = std::stoull(req.path_params.at("id"));
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid job ID");
+    }
+
+    switch (m_training->cancel(job_id)) {
+    case CancelResult::NotFound:
+        co_return ApiResponse::not_found("Job not found");
+    case CancelResult::AlreadyFinished:
+        co_return ApiResponse::error(httc::StatusCode::CONFLICT, "Job already finished");
+    case CancelResult::Cancelled:
+        break;
+    }
+    co_return ApiResponse::ok(m_training->get(job_id).value());
+}
 
-    auto stream = co_await ApiResponse::stream(res);
+// Most variants trained by one sweep
+constexpr size_t MAX_SWEEP_CONFIGS = 64;
+// Trial names append "/<index>" to the sweep name and have to fit the 32 character limit
+constexpr size_t MAX_SWEEP_NAME = 28;
+constexpr int MAX_SWEEP_EPOCHS = 1000;
+// How often a sweep checks on its training jobs
+constexpr auto SWEEP_POLL_INTERVAL = std::chrono::milliseconds(500);
 
-    nn::SGDHyperparams hyperparams{ train_req.learning_rate, 1, train_req.batch_size };
-    for (int epoch = 0; epoch < train_req.epochs; epoch++) {
-        co_await asio::co_spawn(req.thread_pool_executor(), [&]() -> asio::awaitable<void> {
-            network.train_sgd(inputs, labels, hyperparams);
+asio::awaitable<ApiResponse> App::create_sweep(const httc::Request& req) {
+    SweepParams params;
+    try {
+        json j = parse_body(req);
+        j.at("name").get_to(params.name);
+        j.at("configs").get_to(params.configs);
+        params.min_epochs = j.value("min_epochs", 1);
+        params.max_epochs = j.value("max_epochs", params.min_epochs * 8);
+        params.reduction_factor = j.value("reduction_factor", 2);
+        // One trial per training thread, so a sweep keeps every core busy without crowding out
+        // other training jobs
+        params.parallelism = j.value("parallelism", m_config.training_threads);
+        params.priority = j.value("priority", 0);
+        params.weight = j.value("weight", 1.0);
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid JSON body");
+    }
+
+    if (params.name.length() < 2 || params.name.length() > MAX_SWEEP_NAME) {
+        co_return ApiResponse::field_error(
+            { .field = "name",
+              .error = std::format("Name must be 2 to {} characters long", MAX_SWEEP_NAME) }
+        );
+    }
+    if (params.configs.empty() || params.configs.size() > MAX_SWEEP_CONFIGS) {
+        co_return ApiResponse::field_error(
+            { .field = "configs",
+              .error = std::format("A sweep needs 1 to {} configs", MAX_SWEEP_CONFIGS) }
+        );
+    }
+    if (params.min_epochs < 1 || params.max_epochs < params.min_epochs
+        || params.max_epochs > MAX_SWEEP_EPOCHS) {
+        co_return ApiResponse::bad_request(std::format(
+            "Epochs must satisfy 1 <= min_epochs <= max_epochs <= {}", MAX_SWEEP_EPOCHS
+        ));
+    }
+    if (params.reduction_factor < 2) {
+        co_return ApiResponse::bad_request("Reduction factor must be at least 2");
+    }
+    if (params.parallelism < 1) {
+        co_return ApiResponse::bad_request("Parallelism must be positive");
+    }
+    if (!(params.weight > 0)) {
+        co_return ApiResponse::bad_request("Weight must be positive");
+    }
+
+    // Every config is validated before any network is stored
+    std::vector<std::pair<nn::Network, AddNetwork>> networks;
+    for (size_t i = 0; i < params.configs.size(); i++) {
+        const auto& config = params.configs[i];
+        if (!(config.learning_rate > 0) || config.batch_size < 1) {
+            co_return ApiResponse::bad_request(
+                std::format("Config {} needs a positive learning rate and batch size", i)
+            );
+        }
+        auto new_res = new_network(AddNetworkRequest{
+            .name = std::format("{}/{}", params.name, i),
+            .layer_sizes = config.layer_sizes,
+            .activations = config.activations,
+            .loss = config.loss,
+        });
+        if (!new_res) {
+            co_return new_res.error();
+        }
+        networks.push_back(std::move(*new_res));
+    }
+
+    // Each trial is a stored network, so the results of all of them end up in the networks table
+    std::vector<SweepTrial> trials;
+    for (size_t i = 0; i < networks.size(); i++) {
+        auto add_res = co_await m_state->db.add_network(std::move(networks[i].second));
+        if (!add_res) {
+            spdlog::error(
+                "Failed to add sweep network: {} {}", add_res.error().message,
+                add_res.error().code
+            );
+            for (const auto& trial : trials) {
+                co_await m_state->db.delete_network_by_id(trial.network_id);
+            }
+            if (add_res.error().code == SQLITE_CONSTRAINT_UNIQUE) {
+                co_return ApiResponse::field_error(
+                    { .field = "name", .error = "Networks with this name already exist" }
+                );
+            }
+            co_return ApiResponse::internal_error("Failed to add sweep networks");
+        }
+        trials.push_back(SweepTrial{ .config = params.configs[i], .network_id = add_res.value() });
+    }
+
+    auto sweep = m_sweeps.add(std::move(params), std::move(trials));
+    asio::co_spawn(m_io_ctx, run_sweep(sweep), asio::detached);
+
+    co_return ApiResponse::accepted(sweep->info());
+}
+
+asio::awaitable<ApiResponse> App::get_sweeps(const httc::Request& req) {
+    co_return ApiResponse::ok(m_sweeps.list());
+}
+
+asio::awaitable<ApiResponse> App::get_sweep(const httc::Request& req) {
+    uint64_t sweep_id;
+    try {
+        sweep_id = std::stoull(req.path_params.at("id"));
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid sweep ID");
+    }
+
+    auto sweep = m_sweeps.get(sweep_id);
+    if (!sweep) {
+        co_return ApiResponse::not_found("Sweep not found");
+    }
+    co_return ApiResponse::ok(sweep->info());
+}
+
+asio::awaitable<ApiResponse> App::cancel_sweep(const httc::Request& req) {
+    uint64_t sweep_id;
+    try {
+        sweep_id = std::stoull(req.path_params.at("id"));
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid sweep ID");
+    }
+
+    auto sweep = m_sweeps.get(sweep_id);
+    if (!sweep) {
+        co_return ApiResponse::not_found("Sweep not found");
+    }
+    if (sweep->info().status != SweepStatus::Running) {
+        co_return ApiResponse::error(httc::StatusCode::CONFLICT, "Sweep already finished");
+    }
+    // The runner cancels its jobs the next time it checks on them
+    sweep->cancel_requested = true;
+    co_return ApiResponse::ok(sweep->info());
+}
+
+asio::awaitable<void> App::run_sweep(std::shared_ptr<Sweep> sweep) {
+    const auto& params = sweep->params;
+    spdlog::info("Starting sweep {} with {} trials", sweep->id, params.configs.size());
+
+    // Trials still in the race
+    std::vector<size_t> alive(params.configs.size());
+    std::iota(alive.begin(), alive.end(), 0);
+    int target_epochs = params.min_epochs;
+    for (int rung = 0; !alive.empty(); rung++) {
+        {
+            std::lock_guard lock(sweep->mutex);
+            sweep->rung = rung;
+        }
+        co_await train_sweep_rung(*sweep, alive, target_epochs);
+        if (sweep->cancel_requested) {
+            break;
+        }
+
+        for (size_t i : alive) {
+            int network_id;
+            {
+                std::lock_guard lock(sweep->mutex);
+                if (sweep->trials[i].error) {
+                    continue;
+                }
+                network_id = sweep->trials[i].network_id;
+            }
+            auto model = co_await load_model(network_id, false);
+            std::shared_ptr<const Evaluation> evaluation;
+            if (model) {
+                evaluation = co_await evaluation_of(*model);
+            }
+
+            std::lock_guard lock(sweep->mutex);
+            auto& trial = sweep->trials[i];
+            if (!evaluation) {
+                trial.error = "Failed to load network";
+                continue;
+            }
+            trial.correct = evaluation->correct;
+            trial.cost = evaluation->cost;
+        }
+
+        // The last rung keeps only the best trial
+        bool last = target_epochs >= params.max_epochs;
+        std::lock_guard lock(sweep->mutex);
+        auto survivors = successive_halving_survivors(
+            sweep->trials, alive, last ? std::max<int>(alive.size(), 1) : params.reduction_factor
+        );
+        if (survivors.size() <= 1) {
+            last = true;
+        }
+        for (size_t i : alive) {
+            if (std::ranges::find(survivors, i) == survivors.end()) {
+                sweep->trials[i].stopped_at_rung = rung;
+            }
+        }
+        spdlog::info(
+            "Sweep {} rung {} at {} epochs kept {} of {} trials", sweep->id, rung, target_epochs,
+            survivors.size(), alive.size()
+        );
+        alive = std::move(survivors);
+        if (last) {
+            break;
+        }
+        target_epochs = std::min(params.max_epochs, target_epochs * params.reduction_factor);
+    }
+
+    std::lock_guard lock(sweep->mutex);
+    if (sweep->cancel_requested) {
+        sweep->status = SweepStatus::Cancelled;
+    } else if (alive.empty()) {
+        sweep->status = SweepStatus::Failed;
+        sweep->error = "Every trial failed";
+    } else {
+        sweep->status = SweepStatus::Completed;
+        sweep->best_network_id = sweep->trials[alive.front()].network_id;
+    }
+    sweep->finished_at = Sweep::Clock::now();
+    spdlog::info("Sweep {} {}", sweep->id, sweep_status_to_str(sweep->status));
+}
+
+asio::awaitable<void> App::train_sweep_rung(
+    Sweep& sweep, const std::vector<size_t>& trials, int target_epochs
+) {
+    const auto& params = sweep.params;
+    std::deque<size_t> pending(trials.begin(), trials.end());
+    // Trial of every submitted job
+    std::map<uint64_t, size_t> running;
+    asio::steady_timer timer(co_await asio::this_coro::executor);
+
+    while (!pending.empty() || !running.empty()) {
+        if (sweep.cancel_requested) {
+            for (uint64_t job_id : running | std::views::keys) {
+                m_training->cancel(job_id);
+            }
             co_return;
-        }, asio::use_awaitable);
+        }
+
+        while (!pending.empty() && running.size() < static_cast<size_t>(params.parallelism)) {
+            std::lock_guard lock(sweep.mutex);
+            auto& trial = sweep.trials[pending.front()];
+            if (trial.error || trial.epochs >= target_epochs) {
+                pending.pop_front();
+                continue;
+            }
+            auto job = m_training->submit(TrainJobParams{
+                .network_id = trial.network_id,
+                .epochs = target_epochs - trial.epochs,
+                .batch_size = trial.config.batch_size,
+                .learning_rate = trial.config.learning_rate,
+                .micro_batch_size = std::nullopt,
+                .priority = params.priority,
+                .weight = params.weight,
+            });
+            // The queue is full or the network is trained by a job outside the sweep, submitted
+            // again on the next check
+            if (!job) {
+                break;
+            }
+            trial.job_id = job->id;
+            running.emplace(job->id, pending.front());
+            pending.pop_front();
+        }
+
+        timer.expires_after(SWEEP_POLL_INTERVAL);
+        co_await timer.async_wait(asio::use_awaitable);
+
+        for (auto it = running.begin(); it != running.end();) {
+            auto job = m_training->get(it->first);
+            if (job && (job->status == JobStatus::Queued || job->status == JobStatus::Running)) {
+                it++;
+                continue;
+            }
+
+            std::lock_guard lock(sweep.mutex);
+            auto& trial = sweep.trials[it->second];
+            if (job && job->status == JobStatus::Completed) {
+                trial.epochs = target_epochs;
+            } else if (job && job->status == JobStatus::Cancelled) {
+                trial.epochs += job->epochs_done;
+                trial.error = "Training job was cancelled";
+            } else {
+                trial.error = job && job->error ? *job->error : "Training job failed";
+            }
+            it = running.erase(it);
+        }
+    }
+}
 
-        co_await stream.write(std::format("{}\n", epoch + 1));
+asio::awaitable<std::expected<void, std::string>> App::run_training_job(
+    std::shared_ptr<TrainJob> job
+) {
+    const auto& params = job->params;
+
+    // Start from the stored weights, never from a live snapshot
+    auto model = co_await load_model(params.network_id, false);
+    if (!model) {
+        // A job resumed for a network deleted before the restart would otherwise be resumed again
+        // on every start
+        if (model.error().status.code == httc::StatusCode::NOT_FOUND.code) {
+            m_checkpoints->discard(params.network_id);
+        }
+        co_return std::unexpected("Failed to load network");
+    }
+    // Train a private copy, the cached model keeps serving predictions meanwhile
+    const auto& base = **model;
+    auto network = base.network;
+
+    auto inputs = m_state->train_inputs.mat();
+    auto labels = m_state->train_labels.mat();
+
+    nn::SGDHyperparams hyperparams{ params.learning_rate, params.epochs, params.batch_size,
+                                    std::nullopt, params.micro_batch_size };
+    if (params.resume_from
+        && !network.load_parameters(params.resume_from->weights, params.resume_from->biases)) {
+        m_checkpoints->discard(params.network_id);
+        co_return std::unexpected("Checkpoint does not match the network");
+    }
+    nn::SGDTrainer trainer(network, inputs, labels, hyperparams);
+    if (params.resume_from) {
+        const auto& checkpoint = *params.resume_from;
+        nn::SGDTrainerState state{ checkpoint.epoch, checkpoint.batch_offset,
+                                   checkpoint.samples_seen, checkpoint.rng_state };
+        if (!trainer.restore(state)) {
+            m_checkpoints->discard(params.network_id);
+            co_return std::unexpected("Checkpoint does not match the training data");
+        }
+        spdlog::info(
+            "Resuming training job {} at epoch {}, batch {}", job->id, trainer.epoch(),
+            trainer.batch()
+        );
     }
+    int batches_per_epoch = trainer.batches_per_epoch();
+    job->total_batches = static_cast<int64_t>(batches_per_epoch) * params.epochs;
+    // A resumed job reports the progress from before the restart, without counting it as trained
+    // by this run
+    job->epochs_done = trainer.epoch();
+    job->batches_done = static_cast<int64_t>(trainer.epoch()) * batches_per_epoch + trainer.batch();
+    job->samples_done = trainer.samples_seen();
+    job->resumed_samples = trainer.samples_seen();
+
+    // Every checkpoint_batches batches the full training state is queued for the database, so an
+    // interrupted job continues from there after a restart
+    auto job_params = json(params).dump();
+    int batches_since_checkpoint = 0;
+    auto save_checkpoint = [&]() {
+        auto state = trainer.state();
+        m_checkpoints->save(Checkpoint{
+            .network_id = params.network_id,
+            .job_params = job_params,
+            .weights = network.dump_weights(),
+            .biases = network.dump_biases(),
+            .epoch = state.epoch,
+            .batch_offset = state.offset,
+            .samples_seen = state.samples_seen,
+            .rng_state = std::move(state.rng),
+        });
+        batches_since_checkpoint = 0;
+    };
+
+    // Predictions pick up a copy of the weights every live_snapshot_batches batches
+    auto live_slot = std::make_shared<LiveModels::Slot>();
+    m_state->live_models.attach(params.network_id, live_slot);
+    int batches_since_snapshot = 0;
+    auto publish_snapshot = [&]() {
+        live_slot->model.store(std::make_shared<const Model>(Model{
+            .id = base.id,
+            // The version the weights are stored as once the job finishes
+            .version = base.version + 1,
+            .layer_sizes = base.layer_sizes,
+            .network = network,
+            .live = true,
+        }));
+        batches_since_snapshot = 0;
+    };
 
+    // Run a slice of batches at a time, taking turns on the training workers with the other jobs
+    auto& share = m_state->training_share;
+    FairShare::Client client{ .weight = params.weight };
+    FairShare::Membership membership(share, client);
+    // Each batch is traced on the worker running it, epochs and the whole job as spans grouped
+    // under the job id
+    TraceSpan job_span("train_job", "training", job->id, params.network_id);
+    auto epoch_start = Tracer::Clock::now();
+    co_await share.acquire(client);
+    while (!trainer.done() && !job->cancel_requested) {
+        auto [batches, elapsed] = co_await m_state->training_pool.run([&]() {
+            auto start = std::chrono::steady_clock::now();
+            int batches = 0;
+            while (batches < m_config.training_slice_batches && !trainer.done()) {
+                int epoch = trainer.epoch();
+                {
+                    TraceSpan span("batch", "training", 0, trainer.batch());
+                    batches += trainer.step(1);
+                }
+                if (trainer.epoch() != epoch) {
+                    auto now = Tracer::Clock::now();
+                    tracer().record("epoch", "training", epoch_start, now, job->id, epoch);
+                    epoch_start = now;
+                }
+            }
+            batches_since_snapshot += batches;
+            if (batches_since_snapshot >= m_config.live_snapshot_batches) {
+                publish_snapshot();
+            }
+            batches_since_checkpoint += batches;
+            if (batches_since_checkpoint >= m_config.checkpoint_batches && !trainer.done()) {
+                save_checkpoint();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return std::pair{ batches, elapsed };
+        });
+
+        m_metrics.observe_training(trainer.samples_seen() - job->samples_done, batches, elapsed);
+        job->epochs_done = trainer.epoch();
+        job->batches_done = static_cast<int64_t>(trainer.epoch()) * batches_per_epoch
+                            + trainer.batch();
+        job->samples_done = trainer.samples_seen();
+        job->busy_seconds = job->busy_seconds + elapsed.count();
+
+        co_await share.yield(client, elapsed);
+    }
+    // Not holding the worker through the database writes below
+    share.leave(client);
+
+    // Progress made before a cancellation is kept, weights and all. Storing the weights bumps the
+    // version even when the job was cancelled within its first epoch
+    if (trainer.samples_seen() == 0) {
+        m_state->live_models.detach(params.network_id, live_slot);
+        m_checkpoints->discard(params.network_id);
+        co_return std::expected<void, std::string>{};
+    }
     auto update_res = co_await m_state->db.update_network_weights(
-        network_id, network.dump_weights(), network.dump_biases(), train_req.epochs
+        params.network_id, network.dump_weights(), network.dump_biases(), trainer.epoch()
     );
+    // Invalidate before detaching, so predictions go from the snapshot straight to the new weights
+    m_state->model_cache.invalidate(params.network_id);
+    m_state->evaluations.invalidate(params.network_id);
+    m_state->live_models.detach(params.network_id, live_slot);
     if (!update_res) {
-        co_await stream.write("Failed to save trained network\n");
+        // The checkpoint stays, the job resumes from it after a restart
+        co_return std::unexpected("Failed to save trained network");
     }
+    m_checkpoints->discard(params.network_id);
 
-    co_return ApiResponse::stream_end();
+    if (auto trained = co_await load_model(params.network_id, false)) {
+        schedule_evaluation(*trained);
+    }
+
+    co_return std::expected<void, std::string>{};
 }
 
-asio::awaitable<ApiResponse> App::get_data(const httc::Request& req) {
+// Most samples returned by one data_range request
+constexpr int MAX_RANGE_SAMPLES = 1000;
+
+// PNG when asked for explicitly, binary for octet-stream clients, JSON otherwise
+SampleFormat requested_sample_format(const httc::Request& req) {
+    auto accept = request_header(req, "Accept");
+    if (accept && accept->find("image/png") != std::string_view::npos) {
+        return SampleFormat::Png;
+    }
+    if (accepts_binary(req)) {
+        return SampleFormat::Binary;
+    }
+    return SampleFormat::Json;
+}
+
+std::string sample_content_type(SampleFormat format) {
+    switch (format) {
+    case SampleFormat::Json:
+        return "application/json";
+    case SampleFormat::Binary:
+        return std::string(OCTET_STREAM);
+    case SampleFormat::Png:
+        return "image/png";
+    }
+    return "application/json";
+}
+
+// The datasets never change, so responses are immutable and validated by ETag alone
+ApiResponse immutable_response(
+    const httc::Request& req, std::string content_type, std::string data, std::string etag
+) {
+    auto if_none_match = request_header(req, "If-None-Match");
+    bool not_modified = if_none_match
+                        && (*if_none_match == "*"
+                            || if_none_match->find(etag) != std::string_view::npos);
+
+    auto resp = not_modified ? ApiResponse::not_modified()
+                             : ApiResponse::ok_raw(std::move(content_type), std::move(data));
+    resp.headers = {
+        { "ETag", std::move(etag) },
+        { "Cache-Control", "public, max-age=31536000, immutable" },
+        { "Vary", "Accept" },
+    };
+    return resp;
+}
+
+// Parses the :source and :idx path parameters
+std::expected<std::pair<SampleCache*, int>, ApiResponse> sample_from_path(
+    const httc::Request& req, State& state
+) {
     int index;
     try {
         auto idx_str = req.path_params.at("idx");
         index = std::stoi(idx_str);
     } catch (const std::exception&) {
-        co_return ApiResponse::bad_request("Invalid index");
+        return std::unexpected(ApiResponse::bad_request("Invalid index"));
     }
 
-    std::optional<Sample> sample_res;
-
     auto source = req.path_params.at("source");
-    if (source == "test") {
-        sample_res = m_state->get_test_sample(index);
-    } else if (source == "train") {
-        sample_res = m_state->get_train_sample(index);
-    } else {
+    auto samples = state.get_sample_cache(source);
+    if (!samples) {
+        return std::unexpected(ApiResponse::bad_request("Invalid source"));
+    }
+    if (index < 0 || index >= samples->count()) {
+        spdlog::info("Sample from source {} with index {} not found", source, index);
+        return std::unexpected(ApiResponse::not_found("Training sample not found"));
+    }
+    return std::pair{ samples, index };
+}
+
+asio::awaitable<ApiResponse> App::get_data(const httc::Request& req) {
+    auto sample = sample_from_path(req, *m_state);
+    if (!sample) {
+        co_return sample.error();
+    }
+    auto [samples, index] = *sample;
+
+    auto format = requested_sample_format(req);
+    auto etag = samples->etag(index, format);
+    co_return immutable_response(
+        req, sample_content_type(format), *samples->get(index, format), std::move(etag)
+    );
+}
+
+asio::awaitable<ApiResponse> App::get_data_png(const httc::Request& req) {
+    auto sample = sample_from_path(req, *m_state);
+    if (!sample) {
+        co_return sample.error();
+    }
+    auto [samples, index] = *sample;
+
+    auto etag = samples->etag(index, SampleFormat::Png);
+    co_return immutable_response(
+        req, "image/png", *samples->get(index, SampleFormat::Png), std::move(etag)
+    );
+}
+
+asio::awaitable<ApiResponse> App::get_data_range(const httc::Request& req) {
+    int start;
+    int count;
+    try {
+        start = std::stoi(req.path_params.at("start"));
+        count = std::stoi(req.path_params.at("count"));
+    } catch (const std::exception&) {
+        co_return ApiResponse::bad_request("Invalid range");
+    }
+
+    auto samples = m_state->get_sample_cache(req.path_params.at("source"));
+    if (!samples) {
         co_return ApiResponse::bad_request("Invalid source");
     }
+    if (count < 1 || count > MAX_RANGE_SAMPLES) {
+        co_return ApiResponse::bad_request(
+            std::format("Count must be between 1 and {}", MAX_RANGE_SAMPLES)
+        );
+    }
+    if (start < 0 || start > samples->count() - count) {
+        co_return ApiResponse::not_found("Range is outside of the dataset");
+    }
 
-    if (!sample_res) {
-        spdlog::info("Sample from source {} with index {} not found", source, index);
-        co_return ApiResponse::not_found("Training sample not found");
+    // Concatenated binary samples or a JSON array, images are only served one by one
+    auto format = requested_sample_format(req);
+    if (format == SampleFormat::Png) {
+        format = SampleFormat::Json;
+    }
+    auto etag = samples->etag(start, format, count);
+
+    std::string data;
+    if (format == SampleFormat::Json) {
+        data += '[';
+    }
+    for (int i = start; i < start + count; i++) {
+        if (format == SampleFormat::Json && i != start) {
+            data += ',';
+        }
+        data += *samples->get(i, format);
+    }
+    if (format == SampleFormat::Json) {
+        data += ']';
+    }
+
+    co_return immutable_response(req, sample_content_type(format), std::move(data), etag);
+}
+
+asio::awaitable<ApiResponse> App::get_stats(const httc::Request& req) {
+    auto cache_stats = m_state->model_cache.stats();
+    auto training_stats = m_training->stats();
+    auto batcher_stats = m_state->predict_batcher.stats();
+    auto checkpoint_stats = m_checkpoints->stats();
+    co_return ApiResponse::ok(json{
+        { "model_cache",
+          {
+              { "hits", cache_stats.hits },
+              { "misses", cache_stats.misses },
+              { "size", cache_stats.size },
+              { "capacity", cache_stats.capacity },
+          } },
+        { "training",
+          {
+              { "running", training_stats.running },
+              { "queued", training_stats.queued },
+              { "max_running", training_stats.max_running },
+              { "max_queued", training_stats.max_queued },
+          } },
+        { "predict_batcher",
+          {
+              { "requests", batcher_stats.requests },
+              { "batches", batcher_stats.batches },
+              { "max_batch_size", batcher_stats.max_batch_size },
+              { "max_wait_us", batcher_stats.max_wait_us },
+          } },
+        { "checkpoints",
+          {
+              { "written", checkpoint_stats.written },
+              { "coalesced", checkpoint_stats.coalesced },
+          } },
+    });
+}
+
+asio::awaitable<ApiResponse> App::get_ready(const httc::Request& req) {
+    if (!m_ready) {
+        co_return ApiResponse::error(httc::StatusCode::SERVICE_UNAVAILABLE, "Warming up");
+    }
+    co_return ApiResponse::ok(json{ { "ready", true } });
+}
+
+asio::awaitable<ApiResponse> App::get_metrics(const httc::Request& req) {
+    std::string out;
+    m_metrics.write(out);
+
+    write_gauge(out, "nn_ready", "1 once the startup warm-up finished", m_ready ? 1.0 : 0.0);
+
+    auto cache_stats = m_state->model_cache.stats();
+    write_counter(
+        out, "nn_model_cache_hits_total", "Model lookups served from memory",
+        static_cast<double>(cache_stats.hits)
+    );
+    write_counter(
+        out, "nn_model_cache_misses_total", "Model lookups that loaded from the database",
+        static_cast<double>(cache_stats.misses)
+    );
+    write_gauge(
+        out, "nn_model_cache_size", "Models kept in memory", static_cast<double>(cache_stats.size)
+    );
+
+    write_gauge(
+        out, "nn_db_queue_depth", "Database operations waiting for or running on its thread",
+        static_cast<double>(m_state->db.queue_depth())
+    );
+
+    auto batcher_stats = m_state->predict_batcher.stats();
+    write_counter(
+        out, "nn_predict_batcher_requests_total", "Predictions submitted to the batcher",
+        static_cast<double>(batcher_stats.requests)
+    );
+    write_counter(
+        out, "nn_predict_batcher_batches_total", "Batched feed forwards run",
+        static_cast<double>(batcher_stats.batches)
+    );
+
+    auto training_stats = m_training->stats();
+    write_gauge(
+        out, "nn_training_jobs_running", "Training jobs sharing the training workers",
+        static_cast<double>(training_stats.running)
+    );
+    write_gauge(
+        out, "nn_training_jobs_queued", "Training jobs waiting to run",
+        static_cast<double>(training_stats.queued)
+    );
+    // The rate of nn_training_samples_total gives the same over a scrape interval, this is the
+    // throughput of the running jobs since they started
+    double samples_per_second = 0.0;
+    auto now = TrainJob::Clock::now();
+    for (const auto& job : m_training->list()) {
+        if (job.status != JobStatus::Running || !job.started_at) {
+            continue;
+        }
+        auto seconds = std::chrono::duration<double>(now - *job.started_at).count();
+        if (seconds > 0) {
+            samples_per_second += (job.samples_done - job.resumed_samples) / seconds;
+        }
+    }
+    write_gauge(
+        out, "nn_training_samples_per_second", "Combined throughput of the running training jobs",
+        samples_per_second
+    );
+
+    auto checkpoint_stats = m_checkpoints->stats();
+    write_counter(
+        out, "nn_training_checkpoints_written_total", "Training checkpoints written",
+        static_cast<double>(checkpoint_stats.written)
+    );
+
+    co_return ApiResponse::ok_raw("text/plain; version=0.0.4", std::move(out));
+}
+
+asio::awaitable<ApiResponse> App::get_trace(const httc::Request& req) {
+    if (!tracer().enabled()) {
+        co_return ApiResponse::not_found("Tracing is disabled");
+    }
+    co_return ApiResponse::ok_raw("application/json", tracer().export_chrome_json());
+}
+
+asio::awaitable<std::expected<std::shared_ptr<const Model>, ApiResponse>>
+    App::load_model(int network_id, bool prefer_live) {
+    if (prefer_live) {
+        if (auto model = m_state->live_models.get(network_id)) {
+            co_return model;
+        }
+    }
+    if (auto model = m_state->model_cache.get(network_id)) {
+        co_return model;
+    }
+
+    auto generation = m_state->model_cache.generation();
+    auto network_res = co_await m_state->db.get_full_network_by_id(network_id);
+    if (!network_res) {
+        spdlog::error(
+            "Failed to retrieve network with id {}: {} {}", network_id, network_res.error().message,
+            network_res.error().code
+        );
+        co_return std::unexpected(ApiResponse::internal_error("Failed to retrieve network"));
+    }
+    if (!network_res.value()) {
+        spdlog::info("Network with id {} not found", network_id);
+        co_return std::unexpected(ApiResponse::not_found("Network not found"));
+    }
+
+    // Should never be invalid since it was validated on insertion
+    auto model = Model::from_db(network_res.value().value());
+    if (!model) {
+        spdlog::error("Network with id {} could not be parsed", network_id);
+        co_return std::unexpected(ApiResponse::internal_error("Failed to parse network from db"));
     }
 
-    co_return ApiResponse::ok(sample_res.value());
+    auto shared_model = std::make_shared<const Model>(std::move(*model));
+    m_state->model_cache.put(shared_model, generation);
+    co_return shared_model;
 }
 
-void ApiResponse::to_response(httc::Response& res) {
+size_t ApiResponse::to_response(httc::Response& res) {
     res.status = status;
+    for (auto& [name, value] : headers) {
+        res.headers.set(name, std::move(value));
+    }
+    if (raw.has_value()) {
+        auto size = raw->data.size();
+        res.headers.set("Content-Type", raw->content_type);
+        res.set_body(std::move(raw->data));
+        return size;
+    }
     if (!resp.has_value()) {
-        return;
+        return 0;
     }
+    auto body = resp->dump();
+    auto size = body.size();
     res.headers.set("Content-Type", "application/json");
-    res.set_body(resp->dump());
+    res.set_body(std::move(body));
+    return size;
 }
 
 void to_json(json& j, const FieldError& v) {
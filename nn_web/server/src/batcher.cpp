@@ -0,0 +1,140 @@
+#include "batcher.hpp"
+#include <asio.hpp>
+#include <algorithm>
+#include <optional>
+#include "resumer.hpp"
+#include "tracing.hpp"
+
+PredictBatcher::PredictBatcher(
+    asio::any_io_executor compute_executor, size_t max_batch_size,
+    std::chrono::microseconds max_wait
+)
+: m_compute_executor(std::move(compute_executor)),
+  m_max_batch_size(std::max<size_t>(max_batch_size, 1)), m_max_wait(max_wait) {
+}
+
+asio::awaitable<Eigen::VectorXd> PredictBatcher::predict(
+    std::shared_ptr<const Model> model, Eigen::VectorXd input
+) {
+    auto executor = co_await asio::this_coro::executor;
+
+    auto pending = std::make_shared<Pending>();
+    pending->input = std::move(input);
+    m_requests++;
+
+    std::optional<Batch> full_batch;
+    {
+        std::lock_guard lock(m_mutex);
+
+        const Model* key = model.get();
+        auto [it, inserted] = m_batches.try_emplace(key);
+        auto& batch = it->second;
+        if (inserted) {
+            batch.model = std::move(model);
+            batch.serial = m_next_serial++;
+            batch.pending.reserve(m_max_batch_size);
+        }
+        batch.pending.push_back(pending);
+
+        if (batch.pending.size() >= m_max_batch_size) {
+            full_batch = take(it);
+        } else if (inserted) {
+            schedule_flush(executor, key, batch.serial);
+        }
+    }
+
+    if (full_batch) {
+        dispatch(std::move(*full_batch));
+    }
+
+    co_await wait(pending);
+    co_return std::move(pending->output);
+}
+
+asio::awaitable<void> PredictBatcher::wait(std::shared_ptr<Pending> pending) {
+    auto initiate = [pending](auto handler) {
+        auto resume = make_resumer(std::move(handler));
+
+        std::unique_lock lock(pending->mutex);
+        if (pending->done) {
+            lock.unlock();
+            resume();
+        } else {
+            pending->resume = std::move(resume);
+        }
+    };
+    co_await asio::async_initiate<const asio::use_awaitable_t<>, void()>(
+        std::move(initiate), asio::use_awaitable
+    );
+}
+
+void PredictBatcher::complete(Pending& pending) {
+    std::function<void()> resume;
+    {
+        std::lock_guard lock(pending.mutex);
+        pending.done = true;
+        resume = std::move(pending.resume);
+    }
+    if (resume) {
+        resume();
+    }
+}
+
+void PredictBatcher::schedule_flush(
+    asio::any_io_executor executor, const Model* key, uint64_t serial
+) {
+    asio::co_spawn(executor, [this, key, serial]() -> asio::awaitable<void> {
+        asio::steady_timer timer(co_await asio::this_coro::executor, m_max_wait);
+        co_await timer.async_wait(asio::use_awaitable);
+
+        std::optional<Batch> batch;
+        {
+            // The batch may have been flushed for being full already, a new one under the same
+            // key has a different serial
+            std::lock_guard lock(m_mutex);
+            auto it = m_batches.find(key);
+            if (it != m_batches.end() && it->second.serial == serial) {
+                batch = take(it);
+            }
+        }
+        if (batch) {
+            dispatch(std::move(*batch));
+        }
+    }, asio::detached);
+}
+
+PredictBatcher::Batch PredictBatcher::take(Batches::iterator it) {
+    auto batch = std::move(it->second);
+    m_batches.erase(it);
+    return batch;
+}
+
+void PredictBatcher::dispatch(Batch batch) {
+    asio::post(m_compute_executor, [this, batch = std::move(batch)]() mutable {
+        run(std::move(batch));
+    });
+}
+
+void PredictBatcher::run(Batch batch) {
+    TraceSpan span("feed_forward", "inference", 0, batch.pending.size());
+    m_batch_count++;
+
+    const auto& first = batch.pending.front()->input;
+    Eigen::MatrixXd inputs(first.rows(), batch.pending.size());
+    for (size_t i = 0; i < batch.pending.size(); i++) {
+        inputs.col(i) = batch.pending[i]->input;
+    }
+
+    auto outputs = batch.model->network.feed_forward(inputs);
+
+    for (size_t i = 0; i < batch.pending.size(); i++) {
+        auto& pending = *batch.pending[i];
+        pending.output = outputs.col(i);
+        complete(pending);
+    }
+}
+
+PredictBatcherStats PredictBatcher::stats() const {
+    return PredictBatcherStats{ m_requests.load(), m_batch_count.load(), m_max_batch_size,
+                                m_max_wait.count() };
+}
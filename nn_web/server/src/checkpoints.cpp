@@ -0,0 +1,70 @@
+#include "checkpoints.hpp"
+#include <spdlog/spdlog.h>
+#include <asio.hpp>
+
+CheckpointWriter::CheckpointWriter(Db& db, asio::any_io_executor executor)
+: m_db(db), m_executor(std::move(executor)) {
+}
+
+void CheckpointWriter::save(Checkpoint checkpoint) {
+    int network_id = checkpoint.network_id;
+    enqueue(network_id, std::move(checkpoint));
+}
+
+void CheckpointWriter::discard(int network_id) {
+    enqueue(network_id, std::nullopt);
+}
+
+CheckpointWriterStats CheckpointWriter::stats() const {
+    return CheckpointWriterStats{ m_written.load(), m_coalesced.load() };
+}
+
+void CheckpointWriter::enqueue(int network_id, Operation operation) {
+    std::lock_guard lock(m_mutex);
+    auto [it, inserted] = m_pending.insert_or_assign(network_id, std::move(operation));
+    if (!inserted) {
+        m_coalesced++;
+    }
+
+    if (!m_flushing) {
+        m_flushing = true;
+        asio::co_spawn(m_executor, flush(), asio::detached);
+    }
+}
+
+asio::awaitable<void> CheckpointWriter::flush() {
+    while (true) {
+        int network_id;
+        Operation operation;
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_pending.empty()) {
+                m_flushing = false;
+                break;
+            }
+            auto node = m_pending.extract(m_pending.begin());
+            network_id = node.key();
+            operation = std::move(node.mapped());
+        }
+
+        if (operation) {
+            auto res = co_await m_db.save_checkpoint(std::move(*operation));
+            if (!res) {
+                spdlog::error(
+                    "Failed to save checkpoint of network {}: {} {}", network_id,
+                    res.error().message, res.error().code
+                );
+                continue;
+            }
+            m_written++;
+        } else {
+            auto res = co_await m_db.delete_checkpoint(network_id);
+            if (!res) {
+                spdlog::error(
+                    "Failed to delete checkpoint of network {}: {} {}", network_id,
+                    res.error().message, res.error().code
+                );
+            }
+        }
+    }
+}
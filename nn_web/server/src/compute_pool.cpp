@@ -0,0 +1,58 @@
+#include "compute_pool.hpp"
+#include <pthread.h>
+#include <spdlog/spdlog.h>
+#include <asio.hpp>
+#include <format>
+#include "tracing.hpp"
+
+namespace {
+
+void pin_to_cpu(std::jthread& thread, int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0) {
+        spdlog::warn("Failed to pin thread to CPU {}", cpu);
+    }
+#endif
+}
+
+}
+
+ComputePool::ComputePool(std::string name, int threads, const std::vector<int>& cpus)
+: m_name(std::move(name)), m_work(asio::make_work_guard(m_ctx)) {
+    m_threads.reserve(threads);
+    for (int i = 0; i < threads; i++) {
+        auto thread_name = std::format("{}-{}", m_name, i);
+        auto& thread = m_threads.emplace_back([this, thread_name]() {
+            tracer().set_thread_name(thread_name);
+            m_ctx.run();
+        });
+#ifdef __linux__
+        // Thread names are limited to 15 characters
+        pthread_setname_np(thread.native_handle(), thread_name.substr(0, 15).c_str());
+#endif
+        if (!cpus.empty()) {
+            pin_to_cpu(thread, cpus[i % cpus.size()]);
+        }
+    }
+
+    spdlog::info(
+        "Started {} pool with {} threads{}", m_name, threads, cpus.empty() ? "" : " (pinned)"
+    );
+}
+
+ComputePool::~ComputePool() {
+    m_work.reset();
+    m_ctx.stop();
+    m_threads.clear();
+}
+
+asio::any_io_executor ComputePool::executor() {
+    return m_ctx.get_executor();
+}
+
+int ComputePool::size() const {
+    return m_threads.size();
+}
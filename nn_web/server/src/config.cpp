@@ -0,0 +1,95 @@
+#include "config.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdlib>
+#include <ranges>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+std::optional<std::string_view> env(const char* name) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return std::nullopt;
+    }
+    return std::string_view{ value };
+}
+
+long env_int(const char* name, long default_value) {
+    auto value = env(name);
+    if (!value) {
+        return default_value;
+    }
+    try {
+        return std::stol(std::string(*value));
+    } catch (const std::exception&) {
+        spdlog::warn("Invalid value for {}: '{}', using {}", name, *value, default_value);
+        return default_value;
+    }
+}
+
+// Parses "name:n,name:n", skipping malformed entries
+std::unordered_map<std::string, int> parse_sample_rates(std::string_view value) {
+    std::unordered_map<std::string, int> rates;
+    for (auto part : value | std::views::split(',')) {
+        std::string_view entry(part.begin(), part.end());
+        auto colon = entry.find(':');
+        if (colon == std::string_view::npos) {
+            spdlog::warn("Invalid sample rate '{}', expected handler:n", entry);
+            continue;
+        }
+        try {
+            rates[std::string(entry.substr(0, colon))] =
+                std::max(std::stoi(std::string(entry.substr(colon + 1))), 1);
+        } catch (const std::exception&) {
+            spdlog::warn("Invalid sample rate '{}', expected handler:n", entry);
+        }
+    }
+    return rates;
+}
+
+}
+
+Config Config::from_env() {
+    Config config;
+    if (auto assets_path = env("ASSETS_PATH")) {
+        config.static_assets_path = std::string(*assets_path);
+    }
+    config.ws_port = std::clamp(env_int("WS_PORT", 8081), 0L, 65535L);
+    config.ws_idle_timeout = std::chrono::seconds(std::max(env_int("WS_IDLE_TIMEOUT_S", 300), 1L));
+    int cores = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    config.io_threads = std::max(env_int("IO_THREADS", cores), 1L);
+    config.inference_threads = std::max(env_int("INFERENCE_THREADS", std::max(cores / 2, 1)), 1L);
+    config.training_threads =
+        std::max(env_int("TRAINING_THREADS", std::max(cores - config.inference_threads, 1)), 1L);
+    if (env_int("COMPUTE_AFFINITY", 0) != 0) {
+        // Inference gets the first cores, training the ones after it, wrapping around when the
+        // pools ask for more threads than there are cores
+        for (int i = 0; i < config.inference_threads; i++) {
+            config.inference_cpus.push_back(i % cores);
+        }
+        for (int i = 0; i < config.training_threads; i++) {
+            config.training_cpus.push_back((config.inference_threads + i) % cores);
+        }
+    }
+    config.training_jobs_max =
+        std::max(env_int("TRAINING_JOBS_MAX", 4 * config.training_threads), 1L);
+    config.training_queue_max = std::max(env_int("TRAINING_QUEUE_MAX", 32), 0L);
+    config.training_slice_batches = std::max(env_int("TRAINING_SLICE_BATCHES", 32), 1L);
+    config.live_snapshot_batches = std::max(env_int("LIVE_SNAPSHOT_BATCHES", 256), 1L);
+    config.checkpoint_batches = std::max(env_int("CHECKPOINT_BATCHES", 500), 1L);
+    config.trace_buffer_size = std::max(env_int("TRACE_BUFFER_SIZE", 65536), 0L);
+    config.log_queue_size = std::max(env_int("LOG_QUEUE_SIZE", 8192), 1L);
+    config.access_log_sample =
+        parse_sample_rates(env("ACCESS_LOG_SAMPLE").value_or("predict:10,predict_custom:10"));
+    config.model_cache_size = std::max(env_int("MODEL_CACHE_SIZE", 32), 1L);
+    config.predict_batch_max = std::max(env_int("PREDICT_BATCH_MAX", 32), 1L);
+    config.predict_batch_wait =
+        std::chrono::microseconds(std::max(env_int("PREDICT_BATCH_WAIT_US", 500), 0L));
+    config.warmup = env_int("WARMUP", 1) != 0;
+    config.warmup_models = std::max(
+        env_int("WARMUP_MODELS", static_cast<long>(config.model_cache_size)), 0L
+    );
+    return config;
+}
@@ -4,8 +4,13 @@
 #include <expected>
 #include <functional>
 #include "nlohmann/json.hpp"
+#include "tracing.hpp"
 
 Db::Db(std::string_view db_file_path) : m_pool(1) {
+    asio::post(m_pool, []() {
+        tracer().set_thread_name("db");
+    });
+
     spdlog::info("Opening database at {}", db_file_path);
     if (sqlite3_open(db_file_path.data(), &m_db) != SQLITE_OK) {
         throw std::runtime_error("Failed to open database");
@@ -28,6 +33,10 @@ Db::~Db() {
     }
 }
 
+size_t Db::queue_depth() const {
+    return m_queue_depth.load();
+}
+
 void Db::create_tables() {
     auto create_table = [this](const char* sql) {
         char* err_msg = nullptr;
@@ -50,6 +59,7 @@ void Db::create_tables() {
         correct_predictions INTEGER NOT NULL DEFAULT 0,
         training_epochs INTEGER NOT NULL DEFAULT 0,
         cost REAL NOT NULL DEFAULT 0.0,
+        weights_version INTEGER NOT NULL DEFAULT 0,  -- bumped whenever the weights change
         
         weights BLOB NOT NULL,      -- serialized vector<double>
         biases BLOB NOT NULL,       -- serialized vector<double>
@@ -58,6 +68,21 @@ void Db::create_tables() {
     );)";
     create_table(create_networks_table_sql);
 
+    // Databases created before weights_version existed
+    int has_weights_version = 0;
+    sqlite3_exec(
+        m_db, "SELECT 1 FROM pragma_table_info('networks') WHERE name = 'weights_version';",
+        [](void* found, int, char**, char**) {
+        *static_cast<int*>(found) = 1;
+        return 0;
+    }, &has_weights_version, nullptr
+    );
+    if (!has_weights_version) {
+        create_table(
+            "ALTER TABLE networks ADD COLUMN weights_version INTEGER NOT NULL DEFAULT 0;"
+        );
+    }
+
     const char* create_training_sessions_table_sql = R"(
     CREATE TABLE IF NOT EXISTS training_sessions (
         id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -69,18 +94,44 @@ void Db::create_tables() {
         FOREIGN KEY(network_id) REFERENCES networks(id)
     );)";
     create_table(create_training_sessions_table_sql);
+
+    const char* create_checkpoints_table_sql = R"(
+    CREATE TABLE IF NOT EXISTS checkpoints (
+        network_id INTEGER PRIMARY KEY,
+        updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+
+        job_params TEXT NOT NULL,   -- JSON: {"epochs": 5, "batch_size": 32, ...}
+        weights BLOB NOT NULL,      -- serialized vector<double>
+        biases BLOB NOT NULL,       -- serialized vector<double>
+
+        epoch INTEGER NOT NULL,
+        batch_offset INTEGER NOT NULL,
+        samples_seen INTEGER NOT NULL,
+        rng_state TEXT NOT NULL,    -- std::mt19937 state at the start of the epoch
+        FOREIGN KEY(network_id) REFERENCES networks(id)
+    );)";
+    create_table(create_checkpoints_table_sql);
 }
 
+// queue_depth counts the operations waiting for or running on the pool, name labels the trace
+// span of the operation
 template<typename F>
-asio::awaitable<std::invoke_result_t<F>> run_on_pool(F&& operation, asio::thread_pool& pool) {
+asio::awaitable<std::invoke_result_t<F>> run_on_pool(
+    F&& operation, asio::thread_pool& pool, std::atomic<size_t>& queue_depth, const char* name
+) {
     using ReturnType = std::invoke_result_t<F>;
-    co_return co_await asio::co_spawn(pool.executor(), [&]() -> asio::awaitable<ReturnType> {
+    queue_depth++;
+    auto result =
+        co_await asio::co_spawn(pool.executor(), [&]() -> asio::awaitable<ReturnType> {
+        TraceSpan span(name, "db");
         co_return operation();
     }, asio::use_awaitable);
+    queue_depth--;
+    co_return result;
 }
 
-asio::awaitable<DBResult<void>> Db::add_network(const AddNetwork&& network) {
-    co_return co_await run_on_pool([this, network]() -> std::expected<void, DBError> {
+asio::awaitable<DBResult<int>> Db::add_network(const AddNetwork&& network) {
+    co_return co_await run_on_pool([this, network]() -> std::expected<int, DBError> {
         sqlite3_stmt* stmt = m_stmts["add_network"];
 
         sqlite3_bind_text(stmt, 1, network.name.c_str(), -1, SQLITE_STATIC);
@@ -113,8 +164,8 @@ asio::awaitable<DBResult<void>> Db::add_network(const AddNetwork&& network) {
         }
 
         sqlite3_reset(stmt);
-        return {};
-    }, m_pool);
+        return static_cast<int>(sqlite3_last_insert_rowid(m_db));
+    }, m_pool, m_queue_depth, "add_network");
 }
 
 asio::awaitable<DBResult<std::optional<NetworkInfo>>> Db::get_network_by_id(const int id) {
@@ -156,7 +207,7 @@ asio::awaitable<DBResult<std::optional<NetworkInfo>>> Db::get_network_by_id(cons
 
         sqlite3_reset(stmt);
         return network;
-    }, m_pool
+    }, m_pool, m_queue_depth, "get_network_by_id"
     );
 }
 
@@ -206,10 +257,11 @@ asio::awaitable<DBResult<std::optional<NetworkFull>>> Db::get_full_network_by_id
         network.activations = activations_json.get<std::vector<std::string>>();
 
         network.loss = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 10));
+        network.weights_version = sqlite3_column_int(stmt, 11);
 
         sqlite3_reset(stmt);
         return network;
-    }, m_pool
+    }, m_pool, m_queue_depth, "get_full_network_by_id"
     );
 }
 
@@ -258,7 +310,7 @@ asio::awaitable<DBResult<std::vector<NetworkInfo>>> Db::get_networks() {
 
         sqlite3_reset(stmt);
         return networks;
-    }, m_pool);
+    }, m_pool, m_queue_depth, "get_networks");
 }
 
 asio::awaitable<DBResult<bool>> Db::delete_network_by_id(const int id) {
@@ -277,7 +329,7 @@ asio::awaitable<DBResult<bool>> Db::delete_network_by_id(const int id) {
         sqlite3_reset(stmt);
 
         return rows_affected > 0;
-    }, m_pool);
+    }, m_pool, m_queue_depth, "delete_network_by_id");
 }
 
 asio::awaitable<DBResult<void>> Db::update_network_weights(
@@ -304,10 +356,126 @@ asio::awaitable<DBResult<void>> Db::update_network_weights(
             return std::unexpected(DBError{ rc, sqlite3_errstr(rc) });
         }
         return {};
-    }, m_pool
+    }, m_pool, m_queue_depth, "update_network_weights"
+    );
+}
+
+asio::awaitable<DBResult<void>> Db::update_network_evaluation(
+    int id, int version, int correct_predictions, double cost
+) {
+    co_return co_await run_on_pool(
+        [this, id, version, correct_predictions, cost]() -> std::expected<void, DBError> {
+        sqlite3_stmt* stmt = m_stmts["update_network_evaluation"];
+
+        sqlite3_bind_int(stmt, 1, correct_predictions);
+        sqlite3_bind_double(stmt, 2, cost);
+        sqlite3_bind_int(stmt, 3, id);
+        sqlite3_bind_int(stmt, 4, version);
+
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+
+        if (rc != SQLITE_DONE) {
+            return std::unexpected(DBError{ rc, sqlite3_errstr(rc) });
+        }
+        return {};
+    }, m_pool, m_queue_depth, "update_network_evaluation"
     );
 }
 
+asio::awaitable<DBResult<void>> Db::save_checkpoint(Checkpoint checkpoint) {
+    co_return co_await run_on_pool(
+        [this, checkpoint = std::move(checkpoint)]() -> std::expected<void, DBError> {
+        sqlite3_stmt* stmt = m_stmts["save_checkpoint"];
+
+        sqlite3_bind_int(stmt, 1, checkpoint.network_id);
+        sqlite3_bind_text(stmt, 2, checkpoint.job_params.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_blob(
+            stmt, 3, checkpoint.weights.data(),
+            static_cast<int>(checkpoint.weights.size() * sizeof(double)), SQLITE_STATIC
+        );
+        sqlite3_bind_blob(
+            stmt, 4, checkpoint.biases.data(),
+            static_cast<int>(checkpoint.biases.size() * sizeof(double)), SQLITE_STATIC
+        );
+        sqlite3_bind_int(stmt, 5, checkpoint.epoch);
+        sqlite3_bind_int(stmt, 6, checkpoint.batch_offset);
+        sqlite3_bind_int64(stmt, 7, checkpoint.samples_seen);
+        sqlite3_bind_text(stmt, 8, checkpoint.rng_state.c_str(), -1, SQLITE_STATIC);
+
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+
+        if (rc != SQLITE_DONE) {
+            return std::unexpected(DBError{ rc, sqlite3_errstr(rc) });
+        }
+        return {};
+    }, m_pool, m_queue_depth, "save_checkpoint"
+    );
+}
+
+asio::awaitable<DBResult<void>> Db::delete_checkpoint(int network_id) {
+    co_return co_await run_on_pool([this, network_id]() -> std::expected<void, DBError> {
+        sqlite3_stmt* stmt = m_stmts["delete_checkpoint"];
+
+        sqlite3_bind_int(stmt, 1, network_id);
+
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+
+        if (rc != SQLITE_DONE) {
+            return std::unexpected(DBError{ rc, sqlite3_errstr(rc) });
+        }
+        return {};
+    }, m_pool, m_queue_depth, "delete_checkpoint");
+}
+
+asio::awaitable<DBResult<std::vector<Checkpoint>>> Db::get_checkpoints() {
+    co_return co_await run_on_pool([this]() -> std::expected<std::vector<Checkpoint>, DBError> {
+        sqlite3_stmt* stmt = m_stmts["get_checkpoints"];
+
+        std::vector<Checkpoint> checkpoints;
+
+        int rc;
+        while (true) {
+            rc = sqlite3_step(stmt);
+            if (rc != SQLITE_ROW) {
+                break;
+            }
+
+            Checkpoint checkpoint;
+            checkpoint.network_id = sqlite3_column_int(stmt, 0);
+            checkpoint.job_params = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+
+            const void* weights_blob = sqlite3_column_blob(stmt, 2);
+            int weights_size = sqlite3_column_bytes(stmt, 2);
+            checkpoint.weights.resize(weights_size / sizeof(double));
+            std::memcpy(checkpoint.weights.data(), weights_blob, static_cast<size_t>(weights_size));
+
+            const void* biases_blob = sqlite3_column_blob(stmt, 3);
+            int biases_size = sqlite3_column_bytes(stmt, 3);
+            checkpoint.biases.resize(biases_size / sizeof(double));
+            std::memcpy(checkpoint.biases.data(), biases_blob, static_cast<size_t>(biases_size));
+
+            checkpoint.epoch = sqlite3_column_int(stmt, 4);
+            checkpoint.batch_offset = sqlite3_column_int(stmt, 5);
+            checkpoint.samples_seen = sqlite3_column_int64(stmt, 6);
+            checkpoint.rng_state = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 7));
+
+            checkpoints.push_back(std::move(checkpoint));
+        }
+
+        if (rc != SQLITE_DONE) {
+            rc = sqlite3_extended_errcode(m_db);
+            sqlite3_reset(stmt);
+            return std::unexpected(DBError{ rc, sqlite3_errstr(rc) });
+        }
+
+        sqlite3_reset(stmt);
+        return checkpoints;
+    }, m_pool, m_queue_depth, "get_checkpoints");
+}
+
 void Db::create_statements() {
     auto add_stmt = [this](const char* sql, const char* name) {
         sqlite3_stmt* stmt;
@@ -334,7 +502,7 @@ void Db::create_statements() {
     add_stmt(get_network_by_id_sql, "get_network_by_id");
 
     const char* get_full_network_by_id_sql = R"(
-    SELECT id, name, created_at, layer_sizes, correct_predictions, cost, training_epochs, weights, biases, activations, loss
+    SELECT id, name, created_at, layer_sizes, correct_predictions, cost, training_epochs, weights, biases, activations, loss, weights_version
     FROM networks WHERE id = ?;)";
     add_stmt(get_full_network_by_id_sql, "get_full_network_by_id");
 
@@ -347,8 +515,28 @@ void Db::create_statements() {
     add_stmt(delete_network_by_id_sql, "delete_network_by_id");
 
     const char* update_network_weights_sql = R"(
-    UPDATE networks SET weights = ?, biases = ?, training_epochs = training_epochs + ? WHERE id = ?;)";
+    UPDATE networks SET weights = ?, biases = ?, training_epochs = training_epochs + ?, weights_version = weights_version + 1
+    WHERE id = ?;)";
     add_stmt(update_network_weights_sql, "update_network_weights");
+
+    const char* update_network_evaluation_sql = R"(
+    UPDATE networks SET correct_predictions = ?, cost = ? WHERE id = ? AND weights_version = ?;)";
+    add_stmt(update_network_evaluation_sql, "update_network_evaluation");
+
+    const char* save_checkpoint_sql = R"(
+    INSERT OR REPLACE INTO checkpoints (
+        network_id, job_params, weights, biases, epoch, batch_offset, samples_seen, rng_state
+    ) VALUES (?, ?, ?, ?, ?, ?, ?, ?);)";
+    add_stmt(save_checkpoint_sql, "save_checkpoint");
+
+    const char* delete_checkpoint_sql = R"(
+    DELETE FROM checkpoints WHERE network_id = ?;)";
+    add_stmt(delete_checkpoint_sql, "delete_checkpoint");
+
+    const char* get_checkpoints_sql = R"(
+    SELECT network_id, job_params, weights, biases, epoch, batch_offset, samples_seen, rng_state
+    FROM checkpoints;)";
+    add_stmt(get_checkpoints_sql, "get_checkpoints");
 }
 
 void to_json(json& j, const NetworkFull& v) {
@@ -0,0 +1,83 @@
+#include "evaluation.hpp"
+#include "tracing.hpp"
+
+Evaluation Evaluation::compute(
+    const Model& model, const Eigen::Ref<const Eigen::MatrixXd>& inputs,
+    const Eigen::Ref<const Eigen::MatrixXd>& labels
+) {
+    TraceSpan span("evaluate", "inference", 0, inputs.cols());
+
+    Evaluation evaluation{
+        .network_id = model.id,
+        .version = model.version,
+        .outputs = model.network.feed_forward(inputs),
+    };
+
+    int count = inputs.cols();
+    evaluation.losses.resize(count);
+    evaluation.predictions.resize(count);
+    evaluation.correct = 0;
+    for (int i = 0; i < count; i++) {
+        auto output = evaluation.outputs.col(i);
+        evaluation.losses(i) = model.network.output_loss(output, labels.col(i));
+
+        int predicted;
+        int expected;
+        output.maxCoeff(&predicted);
+        labels.col(i).maxCoeff(&expected);
+        evaluation.predictions[i] = predicted;
+        if (predicted == expected) {
+            evaluation.correct++;
+        }
+    }
+    evaluation.cost = count > 0 ? evaluation.losses.mean() : 0.0;
+
+    return evaluation;
+}
+
+std::shared_ptr<const Evaluation> EvaluationCache::get(int id, int version) const {
+    std::lock_guard lock(m_mutex);
+    auto it = m_evaluations.find(id);
+    if (it == m_evaluations.end() || it->second->version != version) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+bool EvaluationCache::try_start(int id, int version) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_evaluations.find(id);
+    if (it != m_evaluations.end() && it->second->version == version) {
+        return false;
+    }
+    return m_in_progress.emplace(id, version).second;
+}
+
+bool EvaluationCache::put(std::shared_ptr<const Evaluation> evaluation) {
+    std::lock_guard lock(m_mutex);
+    auto key = std::pair{ evaluation->network_id, evaluation->version };
+    // Dropped when the network was deleted or retrained while it was being evaluated
+    if (m_in_progress.erase(key) == 0) {
+        return false;
+    }
+
+    auto& current = m_evaluations[evaluation->network_id];
+    // Versions only grow, an older evaluation finishing late does not replace a newer one
+    if (!current || current->version < evaluation->version) {
+        current = std::move(evaluation);
+    }
+    return true;
+}
+
+void EvaluationCache::abandon(int id, int version) {
+    std::lock_guard lock(m_mutex);
+    m_in_progress.erase({ id, version });
+}
+
+void EvaluationCache::invalidate(int id) {
+    std::lock_guard lock(m_mutex);
+    m_evaluations.erase(id);
+    std::erase_if(m_in_progress, [id](const auto& key) {
+        return key.first == id;
+    });
+}
@@ -0,0 +1,109 @@
+#include "fair_share.hpp"
+#include <asio.hpp>
+#include <algorithm>
+#include "resumer.hpp"
+
+FairShare::FairShare(size_t slots) : m_free(std::max<size_t>(slots, 1)) {
+}
+
+FairShare::Membership::Membership(FairShare& share, Client& client)
+: m_share(share), m_client(client) {
+    m_share.join(m_client);
+}
+
+FairShare::Membership::~Membership() {
+    m_share.leave(m_client);
+}
+
+void FairShare::join(Client& client) {
+    std::lock_guard lock(m_mutex);
+    client.virtual_time = m_virtual_time;
+}
+
+asio::awaitable<void> FairShare::acquire(Client& client) {
+    auto initiate = [this, &client](auto handler) {
+        auto resume = make_resumer(std::move(handler));
+
+        std::unique_lock lock(m_mutex);
+        if (m_free > 0 && m_waiters.empty()) {
+            m_free--;
+            grant(client);
+            lock.unlock();
+            resume();
+        } else {
+            m_waiters.push_back(Waiter{ &client, std::move(resume) });
+        }
+    };
+    co_await asio::async_initiate<const asio::use_awaitable_t<>, void()>(
+        std::move(initiate), asio::use_awaitable
+    );
+}
+
+asio::awaitable<void> FairShare::yield(Client& client, std::chrono::duration<double> elapsed) {
+    auto initiate = [this, &client, elapsed](auto handler) {
+        auto resume = make_resumer(std::move(handler));
+
+        std::function<void()> resume_next;
+        {
+            std::lock_guard lock(m_mutex);
+            client.virtual_time += elapsed.count() / client.weight;
+
+            auto next = next_waiter();
+            if (next == m_waiters.end() || next->client->virtual_time >= client.virtual_time) {
+                grant(client);
+                resume_next = std::move(resume);
+            } else {
+                client.has_slot = false;
+                grant(*next->client);
+                resume_next = std::move(next->resume);
+                m_waiters.erase(next);
+                m_waiters.push_back(Waiter{ &client, std::move(resume) });
+            }
+        }
+        resume_next();
+    };
+    co_await asio::async_initiate<const asio::use_awaitable_t<>, void()>(
+        std::move(initiate), asio::use_awaitable
+    );
+}
+
+void FairShare::leave(Client& client) {
+    std::function<void()> resume;
+    // Destroyed once the lock is released
+    std::function<void()> dropped;
+    {
+        std::lock_guard lock(m_mutex);
+        auto waiting = std::ranges::find(m_waiters, &client, &Waiter::client);
+        if (waiting != m_waiters.end()) {
+            dropped = std::move(waiting->resume);
+            m_waiters.erase(waiting);
+            return;
+        }
+        if (!client.has_slot) {
+            return;
+        }
+
+        client.has_slot = false;
+        auto next = next_waiter();
+        if (next == m_waiters.end()) {
+            m_free++;
+            return;
+        }
+
+        grant(*next->client);
+        resume = std::move(next->resume);
+        m_waiters.erase(next);
+    }
+    resume();
+}
+
+void FairShare::grant(Client& client) {
+    client.has_slot = true;
+    m_virtual_time = std::max(m_virtual_time, client.virtual_time);
+}
+
+std::vector<FairShare::Waiter>::iterator FairShare::next_waiter() {
+    return std::ranges::min_element(m_waiters, {}, [](const Waiter& w) {
+        return w.client->virtual_time;
+    });
+}
@@ -0,0 +1,45 @@
+#include "live_models.hpp"
+
+LiveModels::LiveModels() : m_slots(std::make_shared<const Slots>()) {
+}
+
+void LiveModels::attach(int network_id, std::shared_ptr<Slot> slot) {
+    std::lock_guard lock(m_write_mutex);
+    auto slots = std::make_shared<Slots>(*m_slots.load());
+    (*slots)[network_id] = std::move(slot);
+    m_slots.store(std::move(slots));
+}
+
+void LiveModels::detach(int network_id, const std::shared_ptr<Slot>& slot) {
+    std::lock_guard lock(m_write_mutex);
+    auto current = m_slots.load();
+    auto it = current->find(network_id);
+    if (it == current->end() || it->second != slot) {
+        return;
+    }
+
+    auto slots = std::make_shared<Slots>(*current);
+    slots->erase(network_id);
+    m_slots.store(std::move(slots));
+}
+
+void LiveModels::remove(int network_id) {
+    std::lock_guard lock(m_write_mutex);
+    auto current = m_slots.load();
+    if (!current->contains(network_id)) {
+        return;
+    }
+
+    auto slots = std::make_shared<Slots>(*current);
+    slots->erase(network_id);
+    m_slots.store(std::move(slots));
+}
+
+std::shared_ptr<const Model> LiveModels::get(int network_id) const {
+    auto slots = m_slots.load();
+    auto it = slots->find(network_id);
+    if (it == slots->end()) {
+        return nullptr;
+    }
+    return it->second->model.load();
+}
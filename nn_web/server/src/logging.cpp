@@ -0,0 +1,48 @@
+#include "logging.hpp"
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+void init_logging(const Config& config) {
+    spdlog::init_thread_pool(config.log_queue_size, 1);
+
+    // Each logger gets its own sink since the pattern is set on the sink. Both are only written
+    // from the one logging thread
+    auto make_logger = [&](std::string name) {
+        return std::make_shared<spdlog::async_logger>(
+            std::move(name), std::make_shared<spdlog::sinks::stdout_color_sink_mt>(),
+            spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest
+        );
+    };
+    // Unnamed like the logger it replaces, so the output looks the same
+    spdlog::set_default_logger(make_logger(""));
+
+    auto access = make_logger("access");
+    access->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [access] %v");
+    spdlog::register_logger(access);
+}
+
+AccessLog::AccessLog(const Config& config)
+: m_logger(spdlog::get("access")), m_sample_rates(config.access_log_sample) {
+    // Logs synchronously through the default logger when init_logging was not called
+    if (!m_logger) {
+        m_logger = spdlog::default_logger();
+    }
+}
+
+AccessLog::Route* AccessLog::for_handler(std::string_view name) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_routes.find(name);
+    if (it == m_routes.end()) {
+        auto route = std::make_unique<Route>();
+        auto rate = m_sample_rates.find(std::string(name));
+        route->sample_every = rate != m_sample_rates.end() ? rate->second : 1;
+        it = m_routes.emplace(std::string(name), std::move(route)).first;
+    }
+    return it->second.get();
+}
+
+bool AccessLog::Route::sample(int status) {
+    auto count = requests.fetch_add(1, std::memory_order_relaxed);
+    return status >= 400 || count % sample_every == 0;
+}
@@ -1,14 +1,18 @@
-#include <optional>
-#include <string_view>
+#include <spdlog/spdlog.h>
+#include <Eigen/Core>
 #include "app.hpp"
+#include "config.hpp"
+#include "logging.hpp"
 
 int main() {
-    const char* assets_path = std::getenv("ASSETS_PATH");
-    std::optional<std::string_view> assets_path_opt = std::nullopt;
-    if (assets_path) {
-        assets_path_opt = std::string_view{ assets_path };
-    }
+    // Parallelism comes from the compute pools, every pool thread runs its products on its own
+    Eigen::setNbThreads(1);
 
-    App app(assets_path_opt);
+    auto config = Config::from_env();
+    init_logging(config);
+
+    App app(std::move(config));
     app.run();
+
+    spdlog::shutdown();
 }
@@ -0,0 +1,141 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <format>
+
+// Request latencies, from well under a millisecond for cached predictions to the slowest
+// streamed ranges
+const std::vector<double> REQUEST_BUCKETS = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+    0.05,   0.1,     0.25,   0.5,   1.0,    2.5,   5.0,  10.0,
+};
+
+// Time of a single training batch, from tiny batches to large batches on wide networks
+const std::vector<double> BATCH_BUCKETS = {
+    0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001,
+    0.0025,  0.005,    0.01,    0.025,  0.05,    0.1,    0.25,
+};
+
+LatencyHistogram::LatencyHistogram(std::vector<double> bounds)
+: m_bounds(std::move(bounds)), m_buckets(m_bounds.size() + 1) {
+}
+
+void LatencyHistogram::observe(std::chrono::duration<double> duration, uint64_t count) {
+    auto seconds = duration.count();
+    size_t bucket = 0;
+    while (bucket < m_bounds.size() && seconds > m_bounds[bucket]) {
+        bucket++;
+    }
+
+    m_buckets[bucket].fetch_add(count, std::memory_order_relaxed);
+    m_count.fetch_add(count, std::memory_order_relaxed);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    m_sum_ns.fetch_add(static_cast<uint64_t>(ns) * count, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::write(std::string& out, std::string_view name, std::string_view labels)
+    const {
+    auto separator = labels.empty() ? "" : ",";
+
+    // Buckets are read one by one while others keep updating them, a scrape can be off by the
+    // observations made during it
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < m_buckets.size(); i++) {
+        cumulative += m_buckets[i].load(std::memory_order_relaxed);
+        auto le = i < m_bounds.size() ? std::format("{}", m_bounds[i]) : "+Inf";
+        out += std::format(
+            "{}_bucket{{{}{}le=\"{}\"}} {}\n", name, labels, separator, le, cumulative
+        );
+    }
+
+    auto braced = labels.empty() ? std::string() : std::format("{{{}}}", labels);
+    auto sum = static_cast<double>(m_sum_ns.load(std::memory_order_relaxed)) / 1e9;
+    out += std::format("{}_sum{} {}\n", name, braced, sum);
+    out += std::format("{}_count{} {}\n", name, braced, m_count.load(std::memory_order_relaxed));
+}
+
+HandlerMetrics::HandlerMetrics() : responses{}, latency(REQUEST_BUCKETS) {
+}
+
+void HandlerMetrics::observe(int status, std::chrono::duration<double> duration) {
+    auto status_class = std::clamp(status / 100, 1, 5);
+    responses[status_class - 1].fetch_add(1, std::memory_order_relaxed);
+    latency.observe(duration);
+}
+
+Metrics::Metrics() : m_training_batch_time(BATCH_BUCKETS) {
+}
+
+HandlerMetrics* Metrics::for_handler(std::string_view name) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_handlers.find(name);
+    if (it == m_handlers.end()) {
+        it = m_handlers.emplace(std::string(name), std::make_unique<HandlerMetrics>()).first;
+    }
+    return it->second.get();
+}
+
+void Metrics::observe_training(
+    uint64_t samples, uint64_t batches, std::chrono::duration<double> elapsed
+) {
+    m_training_samples.fetch_add(samples, std::memory_order_relaxed);
+    m_training_batches.fetch_add(batches, std::memory_order_relaxed);
+    if (batches > 0) {
+        m_training_batch_time.observe(elapsed / static_cast<double>(batches), batches);
+    }
+}
+
+void Metrics::write(std::string& out) const {
+    std::lock_guard lock(m_mutex);
+
+    write_metric_header(
+        out, "nn_http_responses_total", "counter", "Responses sent, by handler and status class"
+    );
+    for (const auto& [name, handler] : m_handlers) {
+        for (size_t i = 0; i < handler->responses.size(); i++) {
+            out += std::format(
+                "nn_http_responses_total{{handler=\"{}\",code=\"{}xx\"}} {}\n", name, i + 1,
+                handler->responses[i].load(std::memory_order_relaxed)
+            );
+        }
+    }
+
+    write_metric_header(
+        out, "nn_http_request_duration_seconds", "histogram",
+        "Time from routing a request to finishing its response, by handler"
+    );
+    for (const auto& [name, handler] : m_handlers) {
+        handler->latency.write(
+            out, "nn_http_request_duration_seconds", std::format("handler=\"{}\"", name)
+        );
+    }
+
+    write_counter(
+        out, "nn_training_samples_total", "Samples trained on by all jobs",
+        static_cast<double>(m_training_samples.load(std::memory_order_relaxed))
+    );
+    write_counter(
+        out, "nn_training_batches_total", "Batches trained by all jobs",
+        static_cast<double>(m_training_batches.load(std::memory_order_relaxed))
+    );
+    write_metric_header(
+        out, "nn_training_batch_duration_seconds", "histogram",
+        "Time of a training batch on a training worker"
+    );
+    m_training_batch_time.write(out, "nn_training_batch_duration_seconds");
+}
+
+void write_metric_header(
+    std::string& out, std::string_view name, std::string_view type, std::string_view help
+) {
+    out += std::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+}
+
+void write_gauge(std::string& out, std::string_view name, std::string_view help, double value) {
+    write_metric_header(out, name, "gauge", help);
+    out += std::format("{} {}\n", name, value);
+}
+
+void write_counter(std::string& out, std::string_view name, std::string_view help, double value) {
+    write_metric_header(out, name, "counter", help);
+    out += std::format("{} {}\n", name, value);
+}
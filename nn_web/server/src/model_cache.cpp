@@ -0,0 +1,90 @@
+#include "model_cache.hpp"
+#include <ranges>
+#include "tracing.hpp"
+
+std::optional<Model> Model::from_db(const NetworkFull& info) {
+    TraceSpan span("build_network", "model", 0, info.id);
+    if (info.activations.empty()) {
+        return std::nullopt;
+    }
+
+    auto hidden_activations_view =
+        info.activations | std::views::take(info.activations.size() - 1);
+    auto hidden_activations = nn::strs_to_hidden_activation(hidden_activations_view);
+    auto output_activation = nn::str_to_output_activation(info.activations.back());
+    auto loss = nn::str_to_loss(info.loss);
+    if (!hidden_activations || !output_activation || !loss) {
+        return std::nullopt;
+    }
+
+    auto network = nn::Network::from_data(
+        info.layer_sizes, info.weights, info.biases, *hidden_activations, *output_activation,
+        *loss
+    );
+    if (!network) {
+        return std::nullopt;
+    }
+
+    return Model{ info.id, info.weights_version, info.layer_sizes, std::move(*network) };
+}
+
+ModelCache::ModelCache(size_t capacity) : m_capacity(capacity) {
+}
+
+std::shared_ptr<const Model> ModelCache::get(int id) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_index.find(id);
+    if (it == m_index.end()) {
+        m_misses++;
+        return nullptr;
+    }
+
+    m_hits++;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return *it->second;
+}
+
+uint64_t ModelCache::generation() const {
+    std::lock_guard lock(m_mutex);
+    return m_generation;
+}
+
+void ModelCache::put(std::shared_ptr<const Model> model, uint64_t generation) {
+    std::lock_guard lock(m_mutex);
+    if (generation != m_generation) {
+        return;
+    }
+
+    auto it = m_index.find(model->id);
+    if (it != m_index.end()) {
+        *it->second = std::move(model);
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return;
+    }
+
+    if (m_lru.size() >= m_capacity) {
+        m_index.erase(m_lru.back()->id);
+        m_lru.pop_back();
+    }
+
+    int id = model->id;
+    m_lru.push_front(std::move(model));
+    m_index[id] = m_lru.begin();
+}
+
+void ModelCache::invalidate(int id) {
+    std::lock_guard lock(m_mutex);
+    m_generation++;
+
+    auto it = m_index.find(id);
+    if (it == m_index.end()) {
+        return;
+    }
+    m_lru.erase(it->second);
+    m_index.erase(it);
+}
+
+ModelCacheStats ModelCache::stats() const {
+    std::lock_guard lock(m_mutex);
+    return ModelCacheStats{ m_hits.load(), m_misses.load(), m_lru.size(), m_capacity };
+}
@@ -0,0 +1,103 @@
+#include "png.hpp"
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+namespace {
+
+constexpr std::array<uint32_t, 256> CRC_TABLE = []() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+    }
+    return table;
+}();
+
+uint32_t crc32(std::string_view data) {
+    uint32_t c = 0xffffffffu;
+    for (unsigned char byte : data) {
+        c = CRC_TABLE[(c ^ byte) & 0xff] ^ (c >> 8);
+    }
+    return c ^ 0xffffffffu;
+}
+
+uint32_t adler32(std::string_view data) {
+    uint32_t a = 1, b = 0;
+    for (unsigned char byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+void put_u32_be(std::string& out, uint32_t value) {
+    out += static_cast<char>(value >> 24);
+    out += static_cast<char>(value >> 16);
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value);
+}
+
+void put_u16_le(std::string& out, uint16_t value) {
+    out += static_cast<char>(value);
+    out += static_cast<char>(value >> 8);
+}
+
+void put_chunk(std::string& out, std::string_view type, std::string_view data) {
+    put_u32_be(out, data.size());
+    auto start = out.size();
+    out += type;
+    out += data;
+    put_u32_be(out, crc32(std::string_view(out).substr(start)));
+}
+
+// zlib stream of stored (uncompressed) deflate blocks
+std::string zlib_stored(std::string_view data) {
+    constexpr size_t MAX_BLOCK = 65535;
+
+    std::string out;
+    out.reserve(data.size() + data.size() / MAX_BLOCK * 5 + 11);
+    // Deflate with a 32K window, no preset dictionary
+    out += '\x78';
+    out += '\x01';
+    size_t offset = 0;
+    do {
+        auto size = std::min(MAX_BLOCK, data.size() - offset);
+        bool last = offset + size == data.size();
+        out += static_cast<char>(last ? 1 : 0);
+        put_u16_le(out, size);
+        put_u16_le(out, ~size);
+        out += data.substr(offset, size);
+        offset += size;
+    } while (offset < data.size());
+    put_u32_be(out, adler32(data));
+    return out;
+}
+
+}
+
+std::string encode_grayscale_png(std::span<const uint8_t> pixels, uint32_t width, uint32_t height) {
+    // Every row starts with its filter type, 0 for none
+    std::string rows;
+    rows.reserve((width + 1) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        rows += '\0';
+        auto row = pixels.subspan(y * width, width);
+        rows.append(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    std::string header;
+    put_u32_be(header, width);
+    put_u32_be(header, height);
+    // Bit depth 8, grayscale, deflate, no filtering method extensions, no interlace
+    header += std::string_view("\x08\x00\x00\x00\x00", 5);
+
+    std::string png("\x89PNG\r\n\x1a\n", 8);
+    put_chunk(png, "IHDR", header);
+    put_chunk(png, "IDAT", zlib_stored(rows));
+    put_chunk(png, "IEND", "");
+    return png;
+}
@@ -0,0 +1,75 @@
+#include "sample_cache.hpp"
+#include <cmath>
+#include <format>
+#include <nlohmann/json.hpp>
+#include "png.hpp"
+
+using json = nlohmann::json;
+
+// Images are square
+constexpr uint32_t IMAGE_SIDE = 28;
+
+SampleCache::SampleCache(
+    const MemMatrix& inputs, const MemMatrix& labels, std::string_view source
+)
+: m_inputs(inputs), m_labels(labels), m_count(inputs.mat().cols()), m_source(source),
+  m_slots(m_count) {
+}
+
+int SampleCache::count() const {
+    return m_count;
+}
+
+std::shared_ptr<const std::string> SampleCache::get(int index, SampleFormat format) {
+    auto& slot = m_slots[index][static_cast<size_t>(format)];
+    if (auto cached = slot.load(std::memory_order_acquire)) {
+        return cached;
+    }
+
+    auto encoded = std::make_shared<const std::string>(encode(index, format));
+    std::shared_ptr<const std::string> expected = nullptr;
+    if (slot.compare_exchange_strong(expected, encoded, std::memory_order_acq_rel)) {
+        m_cached_bytes += encoded->size();
+        return encoded;
+    }
+    // Another thread stored it first
+    return expected;
+}
+
+std::string SampleCache::etag(int index, SampleFormat format, int count) const {
+    constexpr std::array<std::string_view, 3> FORMAT_NAMES = { "json", "bin", "png" };
+    auto name = FORMAT_NAMES[static_cast<size_t>(format)];
+    if (count == 1) {
+        return std::format("\"{}-{}-{}\"", m_source, index, name);
+    }
+    return std::format("\"{}-{}+{}-{}\"", m_source, index, count, name);
+}
+
+size_t SampleCache::cached_bytes() const {
+    return m_cached_bytes.load();
+}
+
+std::string SampleCache::encode(int index, SampleFormat format) const {
+    auto input = m_inputs.mat().col(index);
+    int label;
+    m_labels.mat().col(index).maxCoeff(&label);
+
+    std::vector<uint8_t> pixels(input.size());
+    for (int i = 0; i < input.size(); i++) {
+        pixels[i] = static_cast<uint8_t>(std::round(input(i) * 255));
+    }
+
+    switch (format) {
+    case SampleFormat::Json:
+        return json{ { "expected_output", label }, { "input", pixels } }.dump();
+    case SampleFormat::Binary: {
+        std::string data(1 + pixels.size(), '\0');
+        data[0] = static_cast<char>(label);
+        std::copy(pixels.begin(), pixels.end(), data.begin() + 1);
+        return data;
+    }
+    case SampleFormat::Png:
+        return encode_grayscale_png(pixels, IMAGE_SIDE, IMAGE_SIDE);
+    }
+    return {};
+}
@@ -1,16 +1,23 @@
 #include "state.hpp"
 
-void to_json(json& j, const Sample& v) {
-    int expected_output;
-    v.label.col(0).maxCoeff(&expected_output);
-    j = json{
-        { "expected_output", expected_output },
-    };
+std::optional<DataSource> State::get_data_source(std::string_view source) const {
+    if (source == "test") {
+        return DataSource{ test_inputs.mat(), test_labels.mat() };
+    }
+    if (source == "train") {
+        return DataSource{ train_inputs.mat(), train_labels.mat() };
+    }
+    return std::nullopt;
+}
 
-    j["input"] = json::array();
-    for (int i = 0; i < v.input.size(); ++i) {
-        j["input"].push_back(static_cast<uint8_t>(std::round(v.input(i) * 255)));
+SampleCache* State::get_sample_cache(std::string_view source) {
+    if (source == "test") {
+        return &test_samples;
+    }
+    if (source == "train") {
+        return &train_samples;
     }
+    return nullptr;
 }
 
 std::optional<Sample> State::get_test_sample(int index) const {
@@ -0,0 +1,158 @@
+#include "sweep.hpp"
+#include <algorithm>
+#include <ranges>
+
+// Sweeps kept around for status queries, finished ones beyond this are forgotten
+constexpr size_t MAX_SWEEPS = 64;
+
+std::string_view sweep_status_to_str(SweepStatus status) {
+    switch (status) {
+    case SweepStatus::Running:
+        return "running";
+    case SweepStatus::Completed:
+        return "completed";
+    case SweepStatus::Failed:
+        return "failed";
+    case SweepStatus::Cancelled:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+void to_json(json& j, const SweepConfig& v) {
+    j = json{
+        { "layer_sizes", v.layer_sizes },
+        { "activations", v.activations },
+        { "loss", v.loss },
+        { "learning_rate", v.learning_rate },
+        { "batch_size", v.batch_size },
+    };
+}
+
+void from_json(const json& j, SweepConfig& v) {
+    j.at("layer_sizes").get_to(v.layer_sizes);
+    j.at("activations").get_to(v.activations);
+    j.at("loss").get_to(v.loss);
+    j.at("learning_rate").get_to(v.learning_rate);
+    j.at("batch_size").get_to(v.batch_size);
+}
+
+void to_json(json& j, const SweepInfo& v) {
+    auto to_ms = [](std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+    };
+
+    json trials = json::array();
+    for (const auto& trial : v.trials) {
+        trials.push_back(json{
+            { "config", trial.config },
+            { "network_id", trial.network_id },
+            { "epochs", trial.epochs },
+            { "job_id", trial.job_id ? json(*trial.job_id) : json(nullptr) },
+            { "correct", trial.correct ? json(*trial.correct) : json(nullptr) },
+            { "cost", trial.cost ? json(*trial.cost) : json(nullptr) },
+            { "stopped_at_rung",
+              trial.stopped_at_rung ? json(*trial.stopped_at_rung) : json(nullptr) },
+            { "error", trial.error ? json(*trial.error) : json(nullptr) },
+        });
+    }
+
+    j = json{
+        { "id", v.id },
+        { "name", v.params.name },
+        { "status", sweep_status_to_str(v.status) },
+        { "rung", v.rung },
+        { "min_epochs", v.params.min_epochs },
+        { "max_epochs", v.params.max_epochs },
+        { "reduction_factor", v.params.reduction_factor },
+        { "parallelism", v.params.parallelism },
+        { "priority", v.params.priority },
+        { "weight", v.params.weight },
+        { "trials", std::move(trials) },
+        { "best_network_id", v.best_network_id ? json(*v.best_network_id) : json(nullptr) },
+        { "created_at", to_ms(v.created_at) },
+        { "finished_at", v.finished_at ? json(to_ms(*v.finished_at)) : json(nullptr) },
+        { "error", v.error ? json(*v.error) : json(nullptr) },
+    };
+}
+
+SweepInfo Sweep::info() const {
+    std::lock_guard lock(mutex);
+    return SweepInfo{
+        .id = id,
+        .params = params,
+        .status = status,
+        .rung = rung,
+        .trials = trials,
+        .best_network_id = best_network_id,
+        .created_at = created_at,
+        .finished_at = finished_at,
+        .error = error,
+    };
+}
+
+std::vector<size_t> successive_halving_survivors(
+    const std::vector<SweepTrial>& trials, const std::vector<size_t>& candidates,
+    int reduction_factor
+) {
+    std::vector<size_t> ranked;
+    for (size_t i : candidates) {
+        if (trials[i].correct && !trials[i].error) {
+            ranked.push_back(i);
+        }
+    }
+    std::ranges::stable_sort(ranked, [&](size_t a, size_t b) {
+        if (*trials[a].correct != *trials[b].correct) {
+            return *trials[a].correct > *trials[b].correct;
+        }
+        return trials[a].cost.value_or(0.0) < trials[b].cost.value_or(0.0);
+    });
+
+    size_t keep = std::max<size_t>(candidates.size() / std::max(reduction_factor, 1), 1);
+    if (ranked.size() > keep) {
+        ranked.resize(keep);
+    }
+    return ranked;
+}
+
+std::shared_ptr<Sweep> SweepRegistry::add(SweepParams params, std::vector<SweepTrial> trials) {
+    auto sweep = std::make_shared<Sweep>();
+    sweep->params = std::move(params);
+    sweep->trials = std::move(trials);
+    sweep->created_at = Sweep::Clock::now();
+
+    std::lock_guard lock(m_mutex);
+    sweep->id = m_next_id++;
+    m_sweeps.emplace(sweep->id, sweep);
+
+    // Forget the oldest finished sweeps
+    for (auto it = m_sweeps.begin(); it != m_sweeps.end() && m_sweeps.size() > MAX_SWEEPS;) {
+        bool finished;
+        {
+            std::lock_guard sweep_lock(it->second->mutex);
+            finished = it->second->status != SweepStatus::Running;
+        }
+        if (finished) {
+            it = m_sweeps.erase(it);
+        } else {
+            it++;
+        }
+    }
+    return sweep;
+}
+
+std::shared_ptr<Sweep> SweepRegistry::get(uint64_t id) const {
+    std::lock_guard lock(m_mutex);
+    auto it = m_sweeps.find(id);
+    return it != m_sweeps.end() ? it->second : nullptr;
+}
+
+std::vector<SweepInfo> SweepRegistry::list() const {
+    std::lock_guard lock(m_mutex);
+    std::vector<SweepInfo> sweeps;
+    sweeps.reserve(m_sweeps.size());
+    for (const auto& sweep : m_sweeps | std::views::values | std::views::reverse) {
+        sweeps.push_back(sweep->info());
+    }
+    return sweeps;
+}
@@ -0,0 +1,146 @@
+#include "tracing.hpp"
+#include <format>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+Tracer& tracer() {
+    static Tracer instance;
+    return instance;
+}
+
+void Tracer::enable(size_t capacity) {
+    m_capacity = capacity;
+    m_slots = capacity ? std::make_unique<Slot[]>(capacity) : nullptr;
+    m_epoch = Clock::now();
+}
+
+uint32_t Tracer::thread_id() {
+    static std::atomic<uint32_t> next_id = 1;
+    thread_local uint32_t id = next_id++;
+    return id;
+}
+
+void Tracer::record(
+    const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+    uint64_t id, int64_t arg
+) {
+    if (!enabled()) {
+        return;
+    }
+
+    auto index = m_next.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = m_slots[index % m_capacity];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.category.store(category, std::memory_order_relaxed);
+    auto start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - m_epoch);
+    slot.start_ns.store(start_ns.count(), std::memory_order_relaxed);
+    auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    slot.duration_ns.store(duration_ns.count(), std::memory_order_relaxed);
+    slot.thread.store(thread_id(), std::memory_order_relaxed);
+    slot.id.store(id, std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::set_thread_name(std::string name) {
+    std::lock_guard lock(m_names_mutex);
+    m_thread_names[thread_id()] = std::move(name);
+}
+
+uint64_t Tracer::recorded() const {
+    return m_next.load(std::memory_order_relaxed);
+}
+
+size_t Tracer::capacity() const {
+    return m_capacity;
+}
+
+std::string Tracer::export_chrome_json() const {
+    std::vector<TraceEvent> events;
+    events.reserve(m_capacity);
+    for (size_t i = 0; i < m_capacity; i++) {
+        const auto& slot = m_slots[i];
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == 0) {
+            continue;
+        }
+        TraceEvent event{
+            .name = slot.name.load(std::memory_order_relaxed),
+            .category = slot.category.load(std::memory_order_relaxed),
+            .start_ns = slot.start_ns.load(std::memory_order_relaxed),
+            .duration_ns = slot.duration_ns.load(std::memory_order_relaxed),
+            .thread = slot.thread.load(std::memory_order_relaxed),
+            .id = slot.id.load(std::memory_order_relaxed),
+            .arg = slot.arg.load(std::memory_order_relaxed),
+        };
+        // A writer took the slot over while it was being read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+        events.push_back(event);
+    }
+
+    // Timestamps are in microseconds
+    auto to_us = [](int64_t ns) {
+        return static_cast<double>(ns) / 1000.0;
+    };
+
+    json trace_events = json::array();
+    {
+        std::lock_guard lock(m_names_mutex);
+        for (const auto& [thread, name] : m_thread_names) {
+            trace_events.push_back(json{
+                { "ph", "M" },
+                { "name", "thread_name" },
+                { "pid", 1 },
+                { "tid", thread },
+                { "args", { { "name", name } } },
+            });
+        }
+    }
+    for (const auto& event : events) {
+        json args = { { "value", event.arg } };
+        if (event.id == 0) {
+            trace_events.push_back(json{
+                { "ph", "X" },
+                { "name", event.name },
+                { "cat", event.category },
+                { "pid", 1 },
+                { "tid", event.thread },
+                { "ts", to_us(event.start_ns) },
+                { "dur", to_us(event.duration_ns) },
+                { "args", args },
+            });
+            continue;
+        }
+
+        auto id = std::format("{:#x}", event.id);
+        trace_events.push_back(json{
+            { "ph", "b" },
+            { "name", event.name },
+            { "cat", event.category },
+            { "id", id },
+            { "pid", 1 },
+            { "tid", event.thread },
+            { "ts", to_us(event.start_ns) },
+            { "args", args },
+        });
+        trace_events.push_back(json{
+            { "ph", "e" },
+            { "name", event.name },
+            { "cat", event.category },
+            { "id", id },
+            { "pid", 1 },
+            { "tid", event.thread },
+            { "ts", to_us(event.start_ns + event.duration_ns) },
+        });
+    }
+
+    return json{ { "traceEvents", std::move(trace_events) }, { "displayTimeUnit", "ms" } }.dump();
+}
@@ -0,0 +1,253 @@
+#include "training.hpp"
+#include <spdlog/spdlog.h>
+#include <asio.hpp>
+
+// Finished jobs kept around for status queries
+constexpr size_t MAX_FINISHED_JOBS = 256;
+
+std::string_view job_status_to_str(JobStatus status) {
+    switch (status) {
+    case JobStatus::Queued:
+        return "queued";
+    case JobStatus::Running:
+        return "running";
+    case JobStatus::Completed:
+        return "completed";
+    case JobStatus::Failed:
+        return "failed";
+    case JobStatus::Cancelled:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+TrainingScheduler::TrainingScheduler(
+    asio::any_io_executor executor, size_t max_running, size_t max_queued, Runner runner
+)
+: m_executor(std::move(executor)), m_max_running(std::max<size_t>(max_running, 1)),
+  m_max_queued(max_queued), m_runner(std::move(runner)) {
+}
+
+std::expected<TrainJobInfo, SubmitError> TrainingScheduler::submit(const TrainJobParams& params) {
+    std::lock_guard lock(m_mutex);
+    if (m_network_jobs.contains(params.network_id)) {
+        return std::unexpected(SubmitError::NetworkBusy);
+    }
+    if (m_running >= m_max_running && m_queue.size() >= m_max_queued) {
+        return std::unexpected(SubmitError::QueueFull);
+    }
+
+    auto job = std::make_shared<TrainJob>();
+    job->id = m_next_id++;
+    job->params = params;
+    job->created_at = TrainJob::Clock::now();
+
+    m_jobs.emplace(job->id, job);
+    m_network_jobs.emplace(params.network_id, job->id);
+    m_queue.emplace(-params.priority, job->id);
+    spdlog::info(
+        "Queued training job {} for network {} with priority {}", job->id, params.network_id,
+        params.priority
+    );
+
+    start_queued();
+    return info(*job);
+}
+
+CancelResult TrainingScheduler::cancel(uint64_t id) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end()) {
+        return CancelResult::NotFound;
+    }
+    return cancel_job(*it->second);
+}
+
+void TrainingScheduler::cancel_network(int network_id) {
+    std::lock_guard lock(m_mutex);
+    auto it = m_network_jobs.find(network_id);
+    if (it != m_network_jobs.end()) {
+        cancel_job(*m_jobs.at(it->second));
+    }
+}
+
+CancelResult TrainingScheduler::cancel_job(TrainJob& job) {
+    switch (job.status) {
+    case JobStatus::Queued:
+        m_queue.erase({ -job.params.priority, job.id });
+        m_network_jobs.erase(job.params.network_id);
+        job.status = JobStatus::Cancelled;
+        job.finished_at = TrainJob::Clock::now();
+        m_finished.push_back(job.id);
+        forget_old_jobs();
+        return CancelResult::Cancelled;
+    case JobStatus::Running:
+        // The runner notices between steps, the job is marked cancelled once it returns
+        job.cancel_requested = true;
+        return CancelResult::Cancelled;
+    default:
+        return CancelResult::AlreadyFinished;
+    }
+}
+
+std::optional<TrainJobInfo> TrainingScheduler::get(uint64_t id) const {
+    std::lock_guard lock(m_mutex);
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end()) {
+        return std::nullopt;
+    }
+    return info(*it->second);
+}
+
+std::vector<TrainJobInfo> TrainingScheduler::list() const {
+    std::lock_guard lock(m_mutex);
+    std::vector<TrainJobInfo> jobs;
+    jobs.reserve(m_jobs.size());
+    for (auto it = m_jobs.rbegin(); it != m_jobs.rend(); it++) {
+        jobs.push_back(info(*it->second));
+    }
+    return jobs;
+}
+
+TrainingSchedulerStats TrainingScheduler::stats() const {
+    std::lock_guard lock(m_mutex);
+    return TrainingSchedulerStats{ m_running, m_queue.size(), m_max_running, m_max_queued };
+}
+
+void TrainingScheduler::start_queued() {
+    while (m_running < m_max_running && !m_queue.empty()) {
+        auto job = m_jobs.at(m_queue.begin()->second);
+        m_queue.erase(m_queue.begin());
+
+        job->status = JobStatus::Running;
+        job->started_at = TrainJob::Clock::now();
+        m_running++;
+        asio::co_spawn(m_executor, run(job), asio::detached);
+    }
+}
+
+void TrainingScheduler::forget_old_jobs() {
+    while (m_finished.size() > MAX_FINISHED_JOBS) {
+        m_jobs.erase(m_finished.front());
+        m_finished.pop_front();
+    }
+}
+
+asio::awaitable<void> TrainingScheduler::run(std::shared_ptr<TrainJob> job) {
+    spdlog::info("Starting training job {}", job->id);
+
+    std::expected<void, std::string> result;
+    try {
+        result = co_await m_runner(job);
+    } catch (const std::exception& e) {
+        result = std::unexpected(e.what());
+    }
+
+    std::lock_guard lock(m_mutex);
+    if (!result) {
+        spdlog::error("Training job {} failed: {}", job->id, result.error());
+        job->status = JobStatus::Failed;
+        job->error = result.error();
+    } else if (job->cancel_requested) {
+        spdlog::info("Training job {} cancelled after {} epochs", job->id, job->epochs_done.load());
+        job->status = JobStatus::Cancelled;
+    } else {
+        spdlog::info("Training job {} completed", job->id);
+        job->status = JobStatus::Completed;
+    }
+    job->finished_at = TrainJob::Clock::now();
+    m_running--;
+    m_network_jobs.erase(job->params.network_id);
+    m_finished.push_back(job->id);
+    forget_old_jobs();
+
+    start_queued();
+}
+
+TrainJobInfo TrainingScheduler::info(const TrainJob& job) {
+    return TrainJobInfo{
+        .id = job.id,
+        .params = job.params,
+        .status = job.status,
+        .epochs_done = job.epochs_done.load(),
+        .batches_done = job.batches_done.load(),
+        .total_batches = job.total_batches.load(),
+        .samples_done = job.samples_done.load(),
+        .resumed_samples = job.resumed_samples.load(),
+        .busy_seconds = job.busy_seconds.load(),
+        .created_at = job.created_at,
+        .started_at = job.started_at,
+        .finished_at = job.finished_at,
+        .error = job.error,
+    };
+}
+
+void to_json(json& j, const TrainJobInfo& v) {
+    auto to_ms = [](TrainJob::Clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+    };
+
+    double progress = 0.0;
+    if (v.total_batches > 0) {
+        progress = static_cast<double>(v.batches_done) / v.total_batches;
+    }
+    // Samples per second of worker time, and of wall time since the job started, which is lower
+    // when the job shares the workers with others. Both only count samples trained since then
+    auto run_samples = static_cast<double>(v.samples_done - v.resumed_samples);
+    double samples_per_second = v.busy_seconds > 0 ? run_samples / v.busy_seconds : 0.0;
+    double wall_samples_per_second = 0.0;
+    if (v.started_at) {
+        auto end = v.finished_at.value_or(TrainJob::Clock::now());
+        auto wall_seconds = std::chrono::duration<double>(end - *v.started_at).count();
+        if (wall_seconds > 0) {
+            wall_samples_per_second = run_samples / wall_seconds;
+        }
+    }
+
+    j = json{
+        { "id", v.id },
+        { "network_id", v.params.network_id },
+        { "status", job_status_to_str(v.status) },
+        { "priority", v.params.priority },
+        { "weight", v.params.weight },
+        { "epochs", v.params.epochs },
+        { "epochs_done", v.epochs_done },
+        { "batches_done", v.batches_done },
+        { "total_batches", v.total_batches },
+        { "progress", progress },
+        { "samples_done", v.samples_done },
+        { "busy_seconds", v.busy_seconds },
+        { "samples_per_second", samples_per_second },
+        { "wall_samples_per_second", wall_samples_per_second },
+        { "batch_size", v.params.batch_size },
+        { "learning_rate", v.params.learning_rate },
+        { "created_at", to_ms(v.created_at) },
+        { "started_at", v.started_at ? json(to_ms(*v.started_at)) : json(nullptr) },
+        { "finished_at", v.finished_at ? json(to_ms(*v.finished_at)) : json(nullptr) },
+        { "error", v.error ? json(*v.error) : json(nullptr) },
+    };
+}
+
+void to_json(json& j, const TrainJobParams& v) {
+    j = json{
+        { "network_id", v.network_id },
+        { "epochs", v.epochs },
+        { "batch_size", v.batch_size },
+        { "learning_rate", v.learning_rate },
+        { "micro_batch_size", v.micro_batch_size ? json(*v.micro_batch_size) : json(nullptr) },
+        { "priority", v.priority },
+        { "weight", v.weight },
+    };
+}
+
+void from_json(const json& j, TrainJobParams& v) {
+    j.at("network_id").get_to(v.network_id);
+    j.at("epochs").get_to(v.epochs);
+    j.at("batch_size").get_to(v.batch_size);
+    j.at("learning_rate").get_to(v.learning_rate);
+    if (!j.at("micro_batch_size").is_null()) {
+        v.micro_batch_size = j.at("micro_batch_size").get<int>();
+    }
+    j.at("priority").get_to(v.priority);
+    j.at("weight").get_to(v.weight);
+}
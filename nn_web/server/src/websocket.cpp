@@ -0,0 +1,362 @@
+#include "websocket.hpp"
+#include <asio.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <span>
+
+namespace {
+
+// Appended to the client key before hashing, fixed by the protocol
+constexpr std::string_view WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// Longest upgrade request accepted
+constexpr size_t MAX_HANDSHAKE_SIZE = 8192;
+
+enum Opcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xa,
+};
+
+std::array<uint8_t, 20> sha1(std::string_view message) {
+    std::array<uint32_t, 5> h = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+    std::string data(message);
+    uint64_t bit_length = static_cast<uint64_t>(message.size()) * 8;
+    data += static_cast<char>(0x80);
+    while (data.size() % 64 != 56) {
+        data += '\0';
+    }
+    for (int i = 7; i >= 0; i--) {
+        data += static_cast<char>(bit_length >> (i * 8));
+    }
+
+    for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+        std::array<uint32_t, 80> w;
+        for (int i = 0; i < 16; i++) {
+            auto byte = [&](int j) {
+                return static_cast<uint32_t>(static_cast<uint8_t>(data[chunk + i * 4 + j]));
+            };
+            w[i] = byte(0) << 24 | byte(1) << 16 | byte(2) << 8 | byte(3);
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = std::rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        auto [a, b, c, d, e] = h;
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            uint32_t temp = std::rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = std::rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest;
+    for (int i = 0; i < 20; i++) {
+        digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - (i % 4) * 8));
+    }
+    return digest;
+}
+
+std::string base64_encode(std::span<const uint8_t> bytes) {
+    constexpr std::string_view ALPHABET =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    out.reserve((bytes.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        uint32_t group = bytes[i] << 16;
+        if (i + 1 < bytes.size()) {
+            group |= bytes[i + 1] << 8;
+        }
+        if (i + 2 < bytes.size()) {
+            group |= bytes[i + 2];
+        }
+        out += ALPHABET[(group >> 18) & 0x3f];
+        out += ALPHABET[(group >> 12) & 0x3f];
+        out += i + 1 < bytes.size() ? ALPHABET[(group >> 6) & 0x3f] : '=';
+        out += i + 2 < bytes.size() ? ALPHABET[group & 0x3f] : '=';
+    }
+    return out;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return std::ranges::equal(a, b, [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x))
+               == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+bool contains_token(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+        auto comma = list.find(',');
+        if (iequals(trim(list.substr(0, comma)), token)) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+}
+
+std::string websocket_accept_key(std::string_view key) {
+    auto digest = sha1(std::string(key) + std::string(WEBSOCKET_GUID));
+    return base64_encode(digest);
+}
+
+WebSocket::WebSocket(asio::ip::tcp::socket socket) : m_socket(std::move(socket)) {
+}
+
+asio::ip::tcp::socket& WebSocket::socket() {
+    return m_socket;
+}
+
+asio::awaitable<std::expected<std::string, std::string>> WebSocket::accept() {
+    using Result = std::expected<std::string, std::string>;
+    auto reject = [this](std::string error) -> asio::awaitable<Result> {
+        std::string_view response = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n"
+                                    "Content-Length: 0\r\n\r\n";
+        co_await asio::async_write(m_socket, asio::buffer(response), asio::use_awaitable);
+        co_return std::unexpected(std::move(error));
+    };
+
+    size_t end;
+    while ((end = m_buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (m_buffer.size() > MAX_HANDSHAKE_SIZE) {
+            co_return co_await reject("Handshake too large");
+        }
+        co_await fill(m_buffer.size() + 1);
+    }
+    std::string request = m_buffer.substr(0, end + 2);
+    m_buffer.erase(0, end + 4);
+
+    auto line_end = request.find("\r\n");
+    std::string_view request_line = std::string_view(request).substr(0, line_end);
+    // GET <path> HTTP/1.1
+    auto first_space = request_line.find(' ');
+    auto last_space = request_line.rfind(' ');
+    if (request_line.substr(0, first_space) != "GET" || first_space == last_space) {
+        co_return co_await reject("Expected a GET request");
+    }
+    std::string path(request_line.substr(first_space + 1, last_space - first_space - 1));
+
+    std::optional<std::string_view> key;
+    bool upgrade = false;
+    bool connection_upgrade = false;
+    std::string_view version;
+    std::string_view headers = std::string_view(request).substr(line_end + 2);
+    while (!headers.empty()) {
+        auto next = headers.find("\r\n");
+        auto header = headers.substr(0, next);
+        headers.remove_prefix(next == std::string_view::npos ? headers.size() : next + 2);
+
+        auto colon = header.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+        auto name = trim(header.substr(0, colon));
+        auto value = trim(header.substr(colon + 1));
+        if (iequals(name, "Upgrade")) {
+            upgrade = contains_token(value, "websocket");
+        } else if (iequals(name, "Connection")) {
+            connection_upgrade = contains_token(value, "upgrade");
+        } else if (iequals(name, "Sec-WebSocket-Key")) {
+            key = value;
+        } else if (iequals(name, "Sec-WebSocket-Version")) {
+            version = value;
+        }
+    }
+    if (!upgrade || !connection_upgrade || !key || version != "13") {
+        co_return co_await reject("Not a WebSocket upgrade request");
+    }
+
+    auto response = std::format(
+        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: {}\r\n\r\n",
+        websocket_accept_key(*key)
+    );
+    co_await asio::async_write(m_socket, asio::buffer(response), asio::use_awaitable);
+    co_return path;
+}
+
+asio::awaitable<std::optional<WebSocketMessage>> WebSocket::read() {
+    std::optional<WebSocketMessage> message;
+    while (true) {
+        co_await fill(2);
+        auto byte0 = static_cast<uint8_t>(m_buffer[0]);
+        auto byte1 = static_cast<uint8_t>(m_buffer[1]);
+        bool fin = byte0 & 0x80;
+        uint8_t opcode = byte0 & 0x0f;
+        bool masked = byte1 & 0x80;
+        uint64_t length = byte1 & 0x7f;
+
+        size_t header_size = 2;
+        if (length == 126) {
+            co_await fill(4);
+            length = static_cast<uint8_t>(m_buffer[2]) << 8 | static_cast<uint8_t>(m_buffer[3]);
+            header_size = 4;
+        } else if (length == 127) {
+            co_await fill(10);
+            length = 0;
+            for (int i = 2; i < 10; i++) {
+                length = length << 8 | static_cast<uint8_t>(m_buffer[i]);
+            }
+            header_size = 10;
+        }
+
+        // Clients must mask every frame
+        if (!masked) {
+            co_await close(1002, "Frames must be masked");
+            co_return std::nullopt;
+        }
+        size_t buffered = message ? message->data.size() : 0;
+        if (length > MAX_MESSAGE_SIZE - buffered) {
+            co_await close(1009, "Message too large");
+            co_return std::nullopt;
+        }
+
+        co_await fill(header_size + 4 + length);
+        std::array<char, 4> mask;
+        std::memcpy(mask.data(), m_buffer.data() + header_size, 4);
+        std::string payload = m_buffer.substr(header_size + 4, length);
+        m_buffer.erase(0, header_size + 4 + length);
+        for (size_t i = 0; i < payload.size(); i++) {
+            payload[i] ^= mask[i % 4];
+        }
+
+        switch (opcode) {
+        case PING:
+            co_await send_frame(PONG, payload);
+            continue;
+        case PONG:
+            continue;
+        case CLOSE:
+            if (!m_close_sent) {
+                // Echo the status code back
+                co_await send_frame(CLOSE, std::string_view(payload).substr(0, 2));
+            }
+            m_socket.close();
+            co_return std::nullopt;
+        case TEXT:
+        case BINARY:
+            if (message) {
+                co_await close(1002, "Expected a continuation frame");
+                co_return std::nullopt;
+            }
+            message = WebSocketMessage{
+                opcode == TEXT ? WebSocketMessage::Type::Text : WebSocketMessage::Type::Binary,
+                std::move(payload),
+            };
+            break;
+        case CONTINUATION:
+            if (!message) {
+                co_await close(1002, "Unexpected continuation frame");
+                co_return std::nullopt;
+            }
+            message->data += payload;
+            break;
+        default:
+            co_await close(1002, "Unknown opcode");
+            co_return std::nullopt;
+        }
+
+        if (fin) {
+            co_return message;
+        }
+    }
+}
+
+asio::awaitable<void> WebSocket::send_binary(std::string_view data) {
+    co_await send_frame(BINARY, data);
+}
+
+asio::awaitable<void> WebSocket::send_text(std::string_view data) {
+    co_await send_frame(TEXT, data);
+}
+
+asio::awaitable<void> WebSocket::close(uint16_t code, std::string_view reason) {
+    if (m_close_sent) {
+        co_return;
+    }
+    std::string payload;
+    payload += static_cast<char>(code >> 8);
+    payload += static_cast<char>(code);
+    // Control frame payloads are at most 125 bytes
+    payload += reason.substr(0, 123);
+    co_await send_frame(CLOSE, payload);
+    m_close_sent = true;
+}
+
+asio::awaitable<void> WebSocket::fill(size_t size) {
+    if (m_buffer.size() >= size) {
+        co_return;
+    }
+    co_await asio::async_read(
+        m_socket, asio::dynamic_buffer(m_buffer), asio::transfer_at_least(size - m_buffer.size()),
+        asio::use_awaitable
+    );
+}
+
+asio::awaitable<void> WebSocket::send_frame(uint8_t opcode, std::string_view payload) {
+    // Server frames are never masked or fragmented
+    std::string frame;
+    frame.reserve(payload.size() + 10);
+    frame += static_cast<char>(0x80 | opcode);
+    if (payload.size() < 126) {
+        frame += static_cast<char>(payload.size());
+    } else if (payload.size() <= 0xffff) {
+        frame += static_cast<char>(126);
+        frame += static_cast<char>(payload.size() >> 8);
+        frame += static_cast<char>(payload.size());
+    } else {
+        frame += static_cast<char>(127);
+        for (int i = 7; i >= 0; i--) {
+            frame += static_cast<char>(static_cast<uint64_t>(payload.size()) >> (i * 8));
+        }
+    }
+    frame += payload;
+    co_await asio::async_write(m_socket, asio::buffer(frame), asio::use_awaitable);
+}
@@ -0,0 +1,81 @@
+#include "wire.hpp"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <format>
+
+namespace {
+
+float load_f32_le(const char* bytes) {
+    uint32_t bits;
+    std::memcpy(&bits, bytes, sizeof(bits));
+    if constexpr (std::endian::native == std::endian::big) {
+        bits = std::byteswap(bits);
+    }
+    return std::bit_cast<float>(bits);
+}
+
+void store_f32_le(float value, char* bytes) {
+    auto bits = std::bit_cast<uint32_t>(value);
+    if constexpr (std::endian::native == std::endian::big) {
+        bits = std::byteswap(bits);
+    }
+    std::memcpy(bytes, &bits, sizeof(bits));
+}
+
+}
+
+std::optional<InputFormat> str_to_input_format(std::string_view s) {
+    if (s == "u8") {
+        return InputFormat::U8;
+    }
+    if (s == "f32") {
+        return InputFormat::F32;
+    }
+    return std::nullopt;
+}
+
+std::expected<Eigen::VectorXd, std::string> decode_input(
+    std::string_view body, std::optional<InputFormat> format, int size
+) {
+    if (!format) {
+        if (body.size() == static_cast<size_t>(size)) {
+            format = InputFormat::U8;
+        } else if (body.size() == size * sizeof(float)) {
+            format = InputFormat::F32;
+        } else {
+            return std::unexpected(
+                std::format("Body must be {} bytes (u8) or {} bytes (f32)", size, size * 4)
+            );
+        }
+    }
+
+    Eigen::VectorXd input(size);
+    switch (*format) {
+    case InputFormat::U8:
+        if (body.size() != static_cast<size_t>(size)) {
+            return std::unexpected(std::format("Body must be {} bytes", size));
+        }
+        for (int i = 0; i < size; i++) {
+            input(i) = static_cast<uint8_t>(body[i]) / 255.0;
+        }
+        break;
+    case InputFormat::F32:
+        if (body.size() != size * sizeof(float)) {
+            return std::unexpected(std::format("Body must be {} bytes", size * sizeof(float)));
+        }
+        for (int i = 0; i < size; i++) {
+            input(i) = load_f32_le(body.data() + i * sizeof(float));
+        }
+        break;
+    }
+    return input;
+}
+
+std::string encode_output(const Eigen::Ref<const Eigen::VectorXd>& output) {
+    std::string bytes(output.size() * sizeof(float), '\0');
+    for (int i = 0; i < output.size(); i++) {
+        store_f32_le(static_cast<float>(output(i)), bytes.data() + i * sizeof(float));
+    }
+    return bytes;
+}